@@ -1,32 +1,214 @@
 #include <BOSS.hpp>
 #include <ExpressionUtilities.hpp>
 
+#include "allocationTracking.cpp"
+#include "benchmarkDaemon.cpp"
 #include "config.hpp"
 #include "dataGeneration.cpp"
+#include "dataSetPrefetching.cpp"
+#include "memoryBandwidth.cpp"
 #include "select.cpp"
 #include "tpch.cpp"
 #include "utilities.cpp"
 #include <benchmark/benchmark.h>
+#include <functional>
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 
 using namespace boss::utilities;
 
-VTuneAPIInterface vtune{"BOSS"};
+Profiler profiler;
+PerfEventCounters perfCounters;
+TraceEvents traceEvents;
 
 bool VERBOSE_QUERY_OUTPUT = false;
 bool VERY_VERBOSE_QUERY_OUTPUT = false;
 bool ENABLE_CONSTRAINTS = false;
+bool DISABLE_COLUMN_CACHE = false;
+bool DISABLE_PARALLEL_LOAD = false;
+bool HARNESS_TBL_PARSING = false;
+bool DISPATCH_FLOOR = false;
+bool PREPARED_QUERIES = false;
 int BENCHMARK_NUM_WARMPUP_ITERATIONS = 0;
+int NUM_DATA_GENERATION_THREADS = 0;
+int64_t SELECT_NUM_TUPLES = 1 * 250 * 1000 * 1000;
+double MEMORY_READ_BANDWIDTH = 0;
+std::string LATENCY_DUMP_DIRECTORY;
 
 std::vector<std::string> librariesToTest = {};
-int latestDataSize = -1;
+int64_t latestDataSize = -1;
 std::string latestDataSet;
 
-int googleBenchmarkApplyParameterHelper = -1;
+static std::vector<benchmark::internal::Benchmark*> registeredBenchmarks;
+static DataSetPrefetcher dataSetPrefetcher;
+static int registeringGroup = -1; // the prefetcher's group of the benchmarks being registered
+
+// Engine thread counts of --threads-sweep (empty = the engines' default) and the engines' setting
+// they are applied with, i.e. "Set"_(<setting>, <threads>)
+static std::vector<int> engineThreadCounts;
+static std::string engineThreadsSetting = "NumberOfThreads";
+static int registeringEngineThreads = 0;
+static int currentEngineThreads = 0;
+// mean latency of every benchmark of the sweep at its first thread count, by benchmark name
+// (without the thread count) and arguments
+static std::map<std::string, double> threadsSweepBaselines;
+
+static void setEngineThreads(int engineThreads) {
+  if(engineThreads == currentEngineThreads) {
+    return;
+  }
+  currentEngineThreads = engineThreads;
+  for(auto const& library : librariesToTest) {
+    auto output = boss::evaluate("EvaluateInEngines"_(
+        "List"_(library), "Set"_(boss::Symbol(engineThreadsSetting), int64_t(engineThreads))));
+    auto* maybeComplexExpr = std::get_if<boss::ComplexExpression>(&output);
+    if(maybeComplexExpr != nullptr &&
+       maybeComplexExpr->getHead() == "ErrorWhenEvaluatingExpression"_) {
+      std::cout << "Error: " << output << std::endl;
+    }
+  }
+}
+
+// Reports the speedup and the parallel efficiency over the sweep's first (i.e. lowest) thread
+// count, from the mean latencies of the benchmark's timed iterations. baselineKey identifies the
+// benchmark and its arguments across the thread counts.
+static void reportThreadScaling(benchmark::State& state, std::string const& baselineKey,
+                                int engineThreads) {
+  auto baselineThreads = engineThreadCounts.front();
+  if(engineThreads == baselineThreads) {
+    threadsSweepBaselines[baselineKey] = lastMeanLatency;
+  }
+  auto baseline = threadsSweepBaselines.find(baselineKey);
+  if(baseline == threadsSweepBaselines.end() || lastMeanLatency <= 0) {
+    return;
+  }
+  auto speedup = baseline->second / lastMeanLatency;
+  state.counters["speedup"] = speedup;
+  state.counters["parallel_efficiency"] = speedup * baselineThreads / engineThreads;
+}
+
+// A registered benchmark that passes the arguments of its run (e.g. "/100/7", empty without
+// arguments) to its function and sets the run's full name as runningBenchmarkName, which State
+// does not expose (State::name() does not include the arguments in Google Benchmark 1.8)
+class HarnessBenchmark : public benchmark::internal::Benchmark {
+public:
+  using Function = std::function<void(benchmark::State&, std::string const&)>;
+  HarnessBenchmark(std::string const& name, Function function)
+      : benchmark::internal::Benchmark(name.c_str()), name(name), function(std::move(function)) {}
+
+  void Run(benchmark::State& state) override {
+    std::string arguments;
+    for(int i = 0; i < ArgsCnt(); ++i) {
+      arguments += "/" + std::to_string(state.range(i));
+    }
+    runningBenchmarkName = name + arguments;
+    if(state.threads() > 1) {
+      runningBenchmarkName += "/threads:" + std::to_string(state.threads());
+    }
+    function(state, arguments);
+  }
+
+private:
+  std::string name;
+  Function function;
+};
+
+// Registers a benchmark measuring real (or, with --prepared-queries, the manually timed
+// evaluation) and process CPU time (the options that apply to all benchmarks, e.g. --clients, are
+// applied once all arguments are parsed)
+template <typename Function, typename... Args>
+static benchmark::internal::Benchmark* registerBenchmark(std::string const& name,
+                                                         Function&& function, Args&&... args) {
+  auto engineThreads = registeringEngineThreads;
+  auto* registered = benchmark::internal::RegisterBenchmarkInternal(new HarnessBenchmark(
+      engineThreads > 0 ? name + "/engine_threads:" + std::to_string(engineThreads) : name,
+      [name, group = registeringGroup, engineThreads, function = std::decay_t<Function>(function),
+       args...](benchmark::State& state, std::string const& arguments) {
+        if(engineThreads > 0 && state.thread_index() == 0) {
+          setEngineThreads(engineThreads);
+        }
+        function(state, args...);
+        if(state.thread_index() == 0) {
+          if(engineThreads > 0) {
+            reportThreadScaling(state, name + arguments, engineThreads);
+          }
+          dataSetPrefetcher.prefetchAfter(group);
+        }
+      }));
+  registered->MeasureProcessCPUTime();
+  if(PREPARED_QUERIES) {
+    registered->UseManualTime(); // set by runQueryBenchmark
+  } else {
+    registered->UseRealTime();
+  }
+  registeredBenchmarks.push_back(registered);
+  return registered;
+}
+
+// The benchmarks are registered (and so run) grouped by the data set they need, so that every
+// data set is built once: the benchmarks of a data set that appears multiple times on the
+// command line run at its first appearance (once per thread count of --threads-sweep).
+// dataFiles are the files that the data set is loaded from (see --prefetch-datasets).
+struct ScheduledBenchmarks {
+  std::string dataSet;
+  std::vector<std::string> dataFiles;
+  std::function<void()> registration;
+};
+// resolved once all arguments are parsed (see the overload taking a function)
+static std::vector<std::function<ScheduledBenchmarks()>> benchmarksToSchedule;
+
+static void scheduleBenchmarks(std::string dataSet, std::vector<std::string> dataFiles,
+                               std::function<void()> registration) {
+  benchmarksToSchedule.emplace_back(
+      [scheduled = ScheduledBenchmarks{std::move(dataSet), std::move(dataFiles),
+                                       std::move(registration)}]() { return scheduled; });
+}
+
+// Schedules benchmarks whose data set depends on options that may still follow on the command
+// line (e.g. --select-num-tuples): schedule is only called once all arguments are parsed
+static void scheduleBenchmarks(std::function<ScheduledBenchmarks()> schedule) {
+  benchmarksToSchedule.push_back(std::move(schedule));
+}
+
+static void registerScheduledBenchmarks() {
+  std::vector<ScheduledBenchmarks> scheduledBenchmarks;
+  for(auto const& schedule : benchmarksToSchedule) {
+    scheduledBenchmarks.push_back(schedule());
+  }
+  benchmarksToSchedule.clear();
+
+  std::vector<std::string> dataSets; // in the order of their first appearance
+  auto threadCounts = engineThreadCounts.empty() ? std::vector<int>{0} : engineThreadCounts;
+  for(auto const& scheduled : scheduledBenchmarks) {
+    if(std::find(dataSets.begin(), dataSets.end(), scheduled.dataSet) == dataSets.end()) {
+      dataSets.push_back(scheduled.dataSet);
+    }
+  }
+  for(auto const& dataSet : dataSets) {
+    std::vector<std::string> dataFiles;
+    for(auto const& scheduled : scheduledBenchmarks) {
+      if(scheduled.dataSet == dataSet) {
+        dataFiles.insert(dataFiles.end(), scheduled.dataFiles.begin(), scheduled.dataFiles.end());
+      }
+    }
+    registeringGroup = dataSetPrefetcher.addGroup(std::move(dataFiles));
+    for(auto engineThreads : threadCounts) {
+      registeringEngineThreads = engineThreads;
+      for(auto const& scheduled : scheduledBenchmarks) {
+        if(scheduled.dataSet == dataSet) {
+          scheduled.registration();
+        }
+      }
+    }
+  }
+  registeringGroup = -1;
+  registeringEngineThreads = 0;
+}
 
 static void releaseBOSSEngines() {
+  auto traceScope = traceEvents.scope("ReleaseEngines", "storage");
   // make sure to release engines in reverse order of evaluation
   // (important for data ownership across engines)
   auto reversedLibraries = librariesToTest;
@@ -37,6 +219,16 @@ static void releaseBOSSEngines() {
 }
 
 void initAndRunBenchmarks(int argc, char** argv) {
+  bool measureBandwidthBaseline = false;
+  std::string noOpEngineLibrary;
+  int numClients = 1;
+  double clientsDuration = 10; // NOLINT: seconds
+  std::string profilerBackend = "itt";
+  std::string perfControlFifos;
+  std::string profilerOutput = "profile.folded";
+  int samplerFrequency = 999; // samples per second of CPU time
+  std::string daemonSocket;
+  std::string numaPolicy;
   for(int i = 0; i < argc; ++i) {
     if(std::string("--library") == argv[i]) {
       if(++i < argc) {
@@ -46,6 +238,14 @@ void initAndRunBenchmarks(int argc, char** argv) {
       if(++i < argc) {
         BENCHMARK_NUM_WARMPUP_ITERATIONS = atoi(argv[i]);
       }
+    } else if(std::string("--data-generation-threads") == argv[i]) {
+      if(++i < argc) {
+        NUM_DATA_GENERATION_THREADS = atoi(argv[i]);
+      }
+    } else if(std::string("--select-num-tuples") == argv[i]) {
+      if(++i < argc) {
+        SELECT_NUM_TUPLES = atoll(argv[i]);
+      }
     } else if(std::string("--verbose-query-output") == argv[i] || std::string("-v") == argv[i]) {
       VERBOSE_QUERY_OUTPUT = true;
     } else if(std::string("--very-verbose-query-output") == argv[i] ||
@@ -54,83 +254,261 @@ void initAndRunBenchmarks(int argc, char** argv) {
       VERY_VERBOSE_QUERY_OUTPUT = true;
     } else if(std::string("--enable-constraints") == argv[i]) {
       ENABLE_CONSTRAINTS = true;
+    } else if(std::string("--disable-column-cache") == argv[i]) {
+      DISABLE_COLUMN_CACHE = true;
+    } else if(std::string("--disable-parallel-load") == argv[i]) {
+      DISABLE_PARALLEL_LOAD = true;
+    } else if(std::string("--harness-tbl-parsing") == argv[i]) {
+      HARNESS_TBL_PARSING = true;
+      benchmark::AddCustomContext(
+          "tbl_parsing", "harness (parsed in parallel and loaded with LoadDataTable, instead of "
+                         "the engine's Load, which may type or store the columns differently)");
+    } else if(std::string("--dispatch-floor") == argv[i]) {
+      // run every benchmark against the no-op engine library (instead of the --library engines)
+      if(++i < argc) {
+        noOpEngineLibrary = argv[i];
+      }
+    } else if(std::string("--prepared-queries") == argv[i]) {
+      PREPARED_QUERIES = true;
+    } else if(std::string("--bandwidth-baseline") == argv[i]) {
+      // measure the memory bandwidth at startup (a few seconds), for column_read_bandwidth_%
+      measureBandwidthBaseline = true;
+    } else if(std::string("--track-allocations") == argv[i]) {
+      allocationTracking::enabled = true;
+    } else if(std::string("--latency-dump") == argv[i]) {
+      if(++i < argc) {
+        LATENCY_DUMP_DIRECTORY = argv[i];
+      }
+    } else if(std::string("--clients") == argv[i]) {
+      if(++i < argc) {
+        numClients = atoi(argv[i]); // threads issuing the benchmarks' queries concurrently
+      }
+    } else if(std::string("--clients-duration") == argv[i]) {
+      if(++i < argc) {
+        // minimum seconds of concurrent queries per benchmark (with --prepared-queries: of their
+        // timed evaluation, i.e. the benchmarks run longer)
+        clientsDuration = atof(argv[i]);
+      }
+    } else if(std::string("--profiler") == argv[i]) {
+      if(++i < argc) {
+        profilerBackend = argv[i]; // none, itt, perf or sampler
+      }
+    } else if(std::string("--perf-control") == argv[i]) {
+      if(++i < argc) {
+        perfControlFifos = argv[i]; // <control fifo>[,<ack fifo>] of perf record --control=fifo:
+      }
+    } else if(std::string("--profiler-output") == argv[i]) {
+      if(++i < argc) {
+        profilerOutput = argv[i];
+      }
+    } else if(std::string("--sampler-frequency") == argv[i]) {
+      if(++i < argc) {
+        samplerFrequency = atoi(argv[i]);
+      }
+    } else if(std::string("--perf-counters") == argv[i]) {
+      // opened before any engine is loaded, so that (without system-wide access) the counters
+      // are inherited by the engines' threads
+      if(perfCounters.open()) {
+        benchmark::AddCustomContext("perf_counters", perfCounters.scope());
+      } else {
+        std::cerr << "Warning: unable to open the hardware performance counters "
+                     "(see /proc/sys/kernel/perf_event_paranoid)"
+                  << std::endl;
+      }
+    } else if(std::string("--daemon") == argv[i]) {
+      if(++i < argc) {
+        daemonSocket = argv[i]; // serve benchmark jobs on this Unix socket (see benchmarkDaemon)
+      }
+    } else if(std::string("--trace-out") == argv[i]) {
+      if(++i < argc && !traceEvents.open(argv[i])) {
+        std::cerr << "Warning: unable to open the trace file " << argv[i] << std::endl;
+      }
+    } else if(std::string("--numa-policy") == argv[i]) {
+      if(++i < argc) {
+        numaPolicy = argv[i]; // local, remote, interleave or node=N
+      }
+    } else if(std::string("--threads-sweep") == argv[i]) {
+      /* register every benchmark once per engine thread count, e.g. --threads-sweep 1,2,4,8 */
+      if(++i < argc) {
+        std::istringstream counts(argv[i]);
+        for(std::string count; std::getline(counts, count, ',');) {
+          engineThreadCounts.push_back(std::max(1, atoi(count.c_str())));
+        }
+        std::sort(engineThreadCounts.begin(), engineThreadCounts.end());
+        engineThreadCounts.erase(std::unique(engineThreadCounts.begin(), engineThreadCounts.end()),
+                                 engineThreadCounts.end());
+      }
+    } else if(std::string("--threads-sweep-setting") == argv[i]) {
+      if(++i < argc) {
+        engineThreadsSetting = argv[i]; // the engines' thread count setting, see setEngineThreads
+      }
+    } else if(std::string("--prefetch-datasets") == argv[i]) {
+      dataSetPrefetcher.enabled = true;
     } else if(std::string("--tpch") == argv[i]) {
       /* register TPC-H benchmarks */
       for(int dataSize : std::vector<int>{1, 10, 100, 1000}) {
-        for(int query : std::vector<int>{TPCH_Q6}) {
-          std::ostringstream testName;
-          auto const& queryName = tpchQueryNames()[DATASETS::TPCH + query];
-          testName << queryName << "/";
-          testName << dataSize << "MB";
-          benchmark::RegisterBenchmark(testName.str(), TPCH_Benchmark, DATASETS::TPCH + query,
-                                       dataSize)
-              ->MeasureProcessCPUTime()
-              ->UseRealTime();
+        scheduleBenchmarks("TPCH/" + std::to_string(dataSize), tpchDataFiles(dataSize),
+                           [dataSize]() {
+                             for(auto const& [queryIdx, queryName] : tpchQueryNames()) {
+                               std::ostringstream testName;
+                               testName << queryName << "/";
+                               testName << dataSize << "MB";
+                               registerBenchmark(testName.str(), TPCH_Benchmark, queryIdx,
+                                                 dataSize, false);
+                             }
+                           });
+      }
+    } else if(std::string("--tpch-generated") == argv[i]) {
+      /* register TPC-H benchmarks on data generated in-process, e.g. --tpch-generated 10000,100000
+       * (sizes in MB, i.e. scale factor * 1000) */
+      std::vector<int> dataSizes;
+      if(++i < argc) {
+        std::istringstream sizes(argv[i]);
+        for(std::string size; std::getline(sizes, size, ',');) {
+          dataSizes.push_back(atoi(size.c_str()));
         }
       }
+      for(int dataSize : dataSizes) {
+        scheduleBenchmarks("TPCH_GENERATED/" + std::to_string(dataSize), {}, [dataSize]() {
+          for(auto const& [queryIdx, queryName] : tpchQueryNames()) {
+            std::ostringstream testName;
+            testName << queryName << "/";
+            testName << dataSize << "MB/generated";
+            registerBenchmark(testName.str(), TPCH_Benchmark, queryIdx, dataSize, true);
+          }
+        });
+      }
     } else if(std::string("--tpch-clustered") == argv[i]) {
       /* register TPC-H Q6 clustering benchmarks */
       int dataSize = 1000;
-      googleBenchmarkApplyParameterHelper = dataSize;
-      std::ostringstream testName;
-      auto const& queryName =
-          tpchQueryNames()[static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q6)];
-      testName << queryName << "/";
-      testName << dataSize << "MB";
-      benchmark::RegisterBenchmark(testName.str(), tpch_q6_clustering_sweep_Benchmark, dataSize)
-          ->MeasureProcessCPUTime()
-          ->UseRealTime()
-          ->Apply([](benchmark::internal::Benchmark* b) {
-            std::string filepath = "../data/tpch_" +
-                                   std::to_string(googleBenchmarkApplyParameterHelper) +
-                                   "MB/lineitem.tbl";
-            std::vector<int> thresholds = generateLogDistribution<int>(
-                30, 1, static_cast<double>(getNumberOfRowsInTable(filepath)));
-            for(int value : thresholds) {
-              b->Arg(value);
+      scheduleBenchmarks(
+          "tpch_q6_clustering_sweep/" + std::to_string(dataSize),
+          tpchDataFiles(dataSize, {"lineitem"}), [dataSize]() {
+            std::ostringstream testName;
+            auto const& queryName =
+                tpchQueryNames()[static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q6)];
+            testName << queryName << "/";
+            testName << dataSize << "MB";
+            // the spreads in cluster range up to the number of rows
+            std::string filepath = "../data/tpch_" + std::to_string(dataSize) + "MB/lineitem.tbl";
+            auto numRows = getNumberOfRowsInTable(filepath);
+            if(!numRows) {
+              std::cerr << "Error: skipping " << testName.str() << std::endl;
+              return;
+            }
+            auto* registered =
+                registerBenchmark(testName.str(), tpch_q6_clustering_sweep_Benchmark, dataSize);
+            std::vector<int64_t> thresholds =
+                generateLogDistribution<int64_t>(30, 1, static_cast<double>(*numRows));
+            for(int64_t value : thresholds) {
+              registered->Arg(value);
             }
           });
     } else if(std::string("--select-selectivity") == argv[i]) {
       /* register selectivity sweep benchmarks */
-      int dataSize = 1 * 250 * 1000 * 1000;
-      std::ostringstream testName;
-      std::string queryName = "selectivity_sweep_uniform_dis";
-      testName << queryName << ",";
-      testName << dataSize << " tuples";
-      benchmark::RegisterBenchmark(testName.str(), selectivity_sweep_uniform_dis_Benchmark,
-                                   dataSize, queryName)
-          ->MeasureProcessCPUTime()
-          ->UseRealTime()
-          ->Apply([](benchmark::internal::Benchmark* b) {
-            std::vector<int> thresholds = generateLogDistribution<int>(30, 1, 10001); // SELECT less than (0-100%)
-            for(int value : thresholds) {
-              b->Arg(value);
-            }
-          });
+      scheduleBenchmarks([]() -> ScheduledBenchmarks {
+        int64_t dataSize = SELECT_NUM_TUPLES; // --select-num-tuples may follow
+        auto registration = [dataSize]() {
+          std::ostringstream testName;
+          std::string queryName = "selectivity_sweep_uniform_dis";
+          testName << queryName << ",";
+          testName << dataSize << " tuples";
+          registerBenchmark(testName.str(), selectivity_sweep_uniform_dis_Benchmark, dataSize,
+                            queryName)
+              ->Apply([](benchmark::internal::Benchmark* b) {
+                // SELECT less than (0-100%)
+                std::vector<int> thresholds = generateLogDistribution<int>(30, 1, 10001);
+                for(int value : thresholds) {
+                  b->Arg(value);
+                }
+              });
+        };
+        return {"selectivity_sweep_uniform_dis/" + std::to_string(dataSize),
+                selectivitySweepDataFiles(dataSize), registration};
+      });
     } else if(std::string("--select-randomness") == argv[i]) {
       /* register randomness sweep benchmarks */
-      int dataSize = 1 * 250 * 1000 * 1000;
-      std::ostringstream testName;
-      std::string queryName = "randomness_sweep_sorted_dis";
-      testName << queryName << "/";
-      testName << dataSize << " tuples";
-      benchmark::RegisterBenchmark(testName.str(), randomness_sweep_sorted_dis_Benchmark, dataSize,
-                                   queryName)
-          ->MeasureProcessCPUTime()
-          ->UseRealTime()
-          ->Apply([](benchmark::internal::Benchmark* b) {
-            std::vector<float> thresholds = generateLogDistribution<float>(10, 0.1, 100);
-            for(float value : thresholds) {
-              b->Arg(static_cast<int>(value * 100)); // Pass value to benchmark as an integer
-            }
-          });
+      scheduleBenchmarks([]() -> ScheduledBenchmarks {
+        int64_t dataSize = SELECT_NUM_TUPLES; // --select-num-tuples may follow
+        auto registration = [dataSize]() {
+          std::ostringstream testName;
+          std::string queryName = "randomness_sweep_sorted_dis";
+          testName << queryName << "/";
+          testName << dataSize << " tuples";
+          registerBenchmark(testName.str(), randomness_sweep_sorted_dis_Benchmark, dataSize,
+                            queryName)
+              ->Apply([](benchmark::internal::Benchmark* b) {
+                std::vector<float> thresholds = generateLogDistribution<float>(10, 0.1, 100);
+                for(float value : thresholds) {
+                  b->Arg(static_cast<int>(value * 100)); // Pass value to benchmark as an integer
+                }
+              });
+        };
+        return {"randomness_sweep_sorted_dis/" + std::to_string(dataSize),
+                randomnessSweepDataFiles(dataSize), registration};
+      });
+    }
+  }
+
+  // before any data set is built (and any engine thread is created)
+  if(!numaPolicy.empty()) {
+    benchmark::AddCustomContext("numa_policy", numa::applyPolicy(numaPolicy));
+  }
+
+  registerScheduledBenchmarks();
+
+  if(profilerBackend == "none") {
+    profiler.useNone();
+  } else if(profilerBackend == "itt") {
+    profiler.useITT();
+  } else if(profilerBackend == "perf") {
+    if(!profiler.usePerf(perfControlFifos)) {
+      std::cerr << "Warning: unable to open the perf control fifo '" << perfControlFifos
+                << "' (--perf-control), profiling disabled" << std::endl;
+    }
+  } else if(profilerBackend == "sampler") {
+    if(!profiler.useSampler(profilerOutput, samplerFrequency)) {
+      std::cerr << "Warning: unable to start the stack sampler, profiling disabled" << std::endl;
+    }
+  } else {
+    std::cerr << "Warning: unknown profiler '" << profilerBackend << "', profiling disabled"
+              << std::endl;
+    profiler.useNone();
+  }
+
+  if(!noOpEngineLibrary.empty()) {
+    DISPATCH_FLOOR = true;
+    librariesToTest = {noOpEngineLibrary};
+    benchmark::AddCustomContext("dispatch_floor", noOpEngineLibrary);
+  }
+
+  if(numClients > 1) {
+    for(auto* registered : registeredBenchmarks) {
+      registered->Threads(numClients)->MinTime(clientsDuration);
     }
   }
 
+  if(measureBandwidthBaseline) {
+    auto traceScope = traceEvents.scope("memory bandwidth baseline");
+    auto baseline = memoryBandwidth::measure();
+    MEMORY_READ_BANDWIDTH = baseline.readBytesPerSecond;
+    benchmark::AddCustomContext("memory_read_bandwidth_GB/s",
+                                std::to_string(baseline.readBytesPerSecond / 1e9)); // NOLINT
+    benchmark::AddCustomContext("memory_copy_bandwidth_GB/s",
+                                std::to_string(baseline.copyBytesPerSecond / 1e9)); // NOLINT
+  }
+
   benchmark::Initialize(&argc, argv);
-  benchmark::RunSpecifiedBenchmarks();
+  if(daemonSocket.empty()) {
+    dataSetPrefetcher.restart();
+    benchmark::RunSpecifiedBenchmarks();
+  } else {
+    benchmarkDaemon::serve(daemonSocket, registeredBenchmarks, dataSetPrefetcher);
+  }
 
+  dataSetPrefetcher.wait();
   releaseBOSSEngines();
+  traceEvents.close();
 }
 
 int main(int argc, char** argv) {
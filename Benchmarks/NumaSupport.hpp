@@ -0,0 +1,160 @@
+#ifndef NUMASUPPORT_H
+#define NUMASUPPORT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // __linux__
+
+// NUMA placement of the benchmarks (--numa-policy), without a libnuma dependency. A policy is
+// applied to the main thread before any data set is built, and so is inherited by every thread
+// created afterwards (data generation and loading threads, the engines' thread pools and the
+// benchmark clients):
+//   local       threads on the first node, memory on the first node
+//   remote      threads on the first node, memory on the second node
+//   interleave  threads anywhere, memory interleaved over all nodes
+//   node=N      threads on node N, memory on node N
+// Memory is placed with a preferred-node (or interleave) memory policy, so that it falls back to
+// the other nodes instead of failing when a node is full. Pages that are already in the page
+// cache (e.g. of the column cache) keep their placement. On a single node, nothing is changed.
+namespace numa {
+
+// parses a sysfs list such as "0-3,8-11"
+static std::vector<int> parseList(std::string const& list) {
+  std::vector<int> values;
+  std::istringstream ranges(list);
+  for(std::string range; std::getline(ranges, range, ',');) {
+    auto separator = range.find('-');
+    try {
+      auto first = std::stoi(range.substr(0, separator));
+      auto last = separator == std::string::npos ? first : std::stoi(range.substr(separator + 1));
+      for(auto value = first; value <= last; ++value) {
+        values.push_back(value);
+      }
+    } catch(std::exception const&) {
+      continue; // e.g. the empty list of a memory-only node
+    }
+  }
+  return values;
+}
+
+static std::vector<int> readList(std::string const& path) {
+  std::string list;
+  std::ifstream(path) >> list;
+  return parseList(list);
+}
+
+static std::vector<int> onlineNodes() { return readList("/sys/devices/system/node/online"); }
+
+static std::vector<int> nodeCPUs(int node) {
+  return readList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+}
+
+// the number of CPUs the calling thread may run on (i.e. respecting the pinning)
+static unsigned availableCPUs() {
+#ifdef __linux__
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  if(sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+    return std::max(1, CPU_COUNT(&cpus));
+  }
+#endif // __linux__
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+static bool pinToNode(int node) {
+#ifdef __linux__
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for(auto cpu : nodeCPUs(node)) {
+    if(cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpus);
+    }
+  }
+  return CPU_COUNT(&cpus) > 0 && sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else
+  (void)node;
+  return false;
+#endif // __linux__
+}
+
+static bool setMemoryPolicy(int mode, std::vector<int> const& nodes) {
+#ifdef __linux__
+  constexpr size_t MAX_NODES = 1024;
+  std::vector<unsigned long> mask(MAX_NODES / (8 * sizeof(unsigned long))); // NOLINT
+  for(auto node : nodes) {
+    if(node >= 0 && static_cast<size_t>(node) < MAX_NODES) {
+      mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    }
+  }
+  return syscall(SYS_set_mempolicy, mode, mask.data(), MAX_NODES + 1) == 0;
+#else
+  (void)mode;
+  (void)nodes;
+  return false;
+#endif // __linux__
+}
+
+// Applies the policy to the calling thread, returns its description for the benchmark context
+static std::string applyPolicy(std::string const& policy) {
+#ifdef __linux__
+  auto nodes = onlineNodes();
+  if(nodes.size() < 2) {
+    std::cerr << "Warning: single NUMA node, --numa-policy " << policy << " is not applied"
+              << std::endl;
+    return policy + " (single node, not applied)";
+  }
+
+  int threadNode = nodes[0];
+  int memoryNode = nodes[0];
+  bool interleave = false;
+  if(policy == "remote") {
+    memoryNode = nodes[1];
+  } else if(policy == "interleave") {
+    interleave = true;
+  } else if(policy.rfind("node=", 0) == 0) {
+    auto node = std::atoi(policy.c_str() + 5); // NOLINT: after "node="
+    if(std::find(nodes.begin(), nodes.end(), node) == nodes.end()) {
+      std::cerr << "Warning: NUMA node " << node << " is not online, --numa-policy is not applied"
+                << std::endl;
+      return policy + " (not online, not applied)";
+    }
+    threadNode = node;
+    memoryNode = node;
+  } else if(policy != "local") {
+    std::cerr << "Warning: unknown --numa-policy '" << policy
+              << "' (expected local, remote, interleave or node=N), not applied" << std::endl;
+    return policy + " (unknown, not applied)";
+  }
+
+  bool applied = interleave ? setMemoryPolicy(MPOL_INTERLEAVE, nodes)
+                            : pinToNode(threadNode) &&
+                                  setMemoryPolicy(MPOL_PREFERRED, {memoryNode});
+  if(!applied) {
+    std::cerr << "Warning: unable to apply --numa-policy " << policy << std::endl;
+    return policy + " (failed)";
+  }
+  if(interleave) {
+    return policy + " (memory interleaved over " + std::to_string(nodes.size()) + " nodes)";
+  }
+  return policy + " (threads on node " + std::to_string(threadNode) + ", memory on node " +
+         std::to_string(memoryNode) + ")";
+#else
+  return policy + " (not supported, not applied)";
+#endif // __linux__
+}
+
+} // namespace numa
+
+#endif // NUMASUPPORT_H
@@ -0,0 +1,207 @@
+#ifndef PERFEVENTSUPPORT_H
+#define PERFEVENTSUPPORT_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // __linux__
+
+// Hardware performance counters (cycles, instructions, LLC misses, dTLB misses and branch misses)
+// via perf_event_open. The counters are opened system-wide (one per CPU) when permitted, so that
+// the work of the engines' thread pools is included; otherwise they count this process: the
+// calling thread and the threads it creates afterwards, whose counts the kernel only adds once
+// they exit. In process mode, the work of engine pool threads that are still alive is therefore
+// only partly counted (just what their exited siblings did), and the counts of threads that exit
+// between two measurements (e.g. the data generation threads) are excluded by reporting the
+// difference between the readings at start() and at read(). Events the hardware does not support
+// are skipped.
+class PerfEventCounters {
+public:
+  PerfEventCounters() = default;
+  PerfEventCounters(PerfEventCounters const&) = delete;
+  PerfEventCounters& operator=(PerfEventCounters const&) = delete;
+  ~PerfEventCounters() { close(); }
+
+  // returns false if no counter could be opened (e.g. because of perf_event_paranoid)
+  bool open() {
+#ifdef __linux__
+    close();
+    auto numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    systemWide = true;
+    for(auto const& event : events()) {
+      auto& counter = counters.emplace_back(Counter{event.name, {}, {}});
+      for(long cpu = 0; cpu < numCPUs; ++cpu) {
+        auto fd = openEvent(event, -1, static_cast<int>(cpu));
+        if(fd < 0) {
+          break;
+        }
+        counter.fds.push_back(fd);
+      }
+      if(counter.fds.size() != static_cast<size_t>(numCPUs)) {
+        closeCounter(counter);
+      }
+    }
+    if(numOpenCounters() == 0) {
+      systemWide = false;
+      for(auto& counter : counters) {
+        auto fd = openEvent(eventByName(counter.name), 0, -1);
+        if(fd >= 0) {
+          counter.fds.push_back(fd);
+        }
+      }
+    }
+    return numOpenCounters() > 0;
+#else
+    return false;
+#endif // __linux__
+  }
+
+  bool isOpen() const { return numOpenCounters() > 0; }
+  char const* scope() const { return systemWide ? "system-wide" : "process"; }
+
+  void start() {
+#ifdef __linux__
+    for(auto& counter : counters) {
+      counter.startReadings.clear();
+      for(auto fd : counter.fds) {
+        // not reset: a reset does not clear what exited child threads have added to the counter
+        counter.startReadings.push_back(readCounter(fd));
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif // __linux__
+  }
+
+  void stop() const {
+#ifdef __linux__
+    for(auto const& counter : counters) {
+      for(auto fd : counter.fds) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+#endif // __linux__
+  }
+
+  // counts since the last start() (until stop()), scaled for multiplexing
+  std::vector<std::pair<std::string, double>> read() const {
+    std::vector<std::pair<std::string, double>> values;
+#ifdef __linux__
+    for(auto const& counter : counters) {
+      if(counter.fds.empty()) {
+        continue;
+      }
+      double total = 0;
+      for(size_t i = 0; i < counter.fds.size(); ++i) {
+        auto reading = readCounter(counter.fds[i]);
+        auto const& start = i < counter.startReadings.size() ? counter.startReadings[i] : Reading{};
+        if(reading.timeRunning > start.timeRunning && reading.value >= start.value) {
+          total += static_cast<double>(reading.value - start.value) *
+                   static_cast<double>(reading.timeEnabled - start.timeEnabled) /
+                   static_cast<double>(reading.timeRunning - start.timeRunning);
+        }
+      }
+      values.emplace_back(counter.name, total);
+    }
+#endif // __linux__
+    return values;
+  }
+
+private:
+  struct Event {
+    char const* name;
+    uint32_t type;
+    uint64_t config;
+  };
+  struct Reading {
+    uint64_t value = 0;
+    uint64_t timeEnabled = 0;
+    uint64_t timeRunning = 0;
+  };
+  struct Counter {
+    std::string name;
+    std::vector<int> fds;
+    std::vector<Reading> startReadings; // per fd, at the last start()
+  };
+
+#ifdef __linux__
+  static std::vector<Event> const& events() {
+    static auto const cacheMiss = [](uint64_t cache) {
+      return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8U) |
+             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U); // NOLINT
+    };
+    static std::vector<Event> const events = {
+        {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {"LLC-misses", PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL)},
+        {"dTLB-misses", PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB)},
+        {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}};
+    return events;
+  }
+
+  static Reading readCounter(int fd) {
+    Reading reading;
+    if(::read(fd, &reading, sizeof(reading)) != sizeof(reading)) {
+      return {};
+    }
+    return reading;
+  }
+
+  static Event const& eventByName(std::string const& name) {
+    for(auto const& event : events()) {
+      if(name == event.name) {
+        return event;
+      }
+    }
+    return events().front();
+  }
+
+  static int openEvent(Event const& event, pid_t pid, int cpu) {
+    perf_event_attr attributes{};
+    attributes.size = sizeof(attributes);
+    attributes.type = event.type;
+    attributes.config = event.config;
+    attributes.disabled = 1;
+    attributes.inherit = pid == 0 ? 1 : 0;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, pid, cpu, -1, 0));
+  }
+#endif // __linux__
+
+  size_t numOpenCounters() const {
+    size_t numOpen = 0;
+    for(auto const& counter : counters) {
+      numOpen += counter.fds.empty() ? 0 : 1;
+    }
+    return numOpen;
+  }
+
+  static void closeCounter(Counter& counter) {
+#ifdef __linux__
+    for(auto fd : counter.fds) {
+      ::close(fd);
+    }
+#endif // __linux__
+    counter.fds.clear();
+  }
+
+  void close() {
+    for(auto& counter : counters) {
+      closeCounter(counter);
+    }
+    counters.clear();
+  }
+
+  std::vector<Counter> counters;
+  bool systemWide = false;
+};
+
+#endif // PERFEVENTSUPPORT_H
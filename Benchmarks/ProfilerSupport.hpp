@@ -0,0 +1,309 @@
+#ifndef PROFILERSUPPORT_H
+#define PROFILERSUPPORT_H
+
+#include "ITTNotifySupport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <csignal>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif // __linux__
+
+// Controls a `perf record` session through its control FIFOs, e.g.
+//   mkfifo ctl ack
+//   perf record -g -D -1 --control=fifo:ctl,ack -- ./Benchmarks --profiler perf
+//       --perf-control ctl,ack ...
+// so that the recording is only enabled while a benchmark's timed loop runs
+class PerfControl {
+  int controlFd = -1;
+  int ackFd = -1;
+
+public:
+  PerfControl() = default;
+  PerfControl(PerfControl const&) = delete;
+  PerfControl& operator=(PerfControl const&) = delete;
+  ~PerfControl() { close(); }
+
+  // fifos is "<control fifo>[,<ack fifo>]", as passed to perf's --control=fifo:
+  bool open(std::string const& fifos) {
+#ifdef __linux__
+    close();
+    auto separator = fifos.find(',');
+    controlFd = ::open(fifos.substr(0, separator).c_str(), O_WRONLY | O_CLOEXEC);
+    if(controlFd >= 0 && separator != std::string::npos) {
+      ackFd = ::open(fifos.substr(separator + 1).c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    return controlFd >= 0;
+#else
+    (void)fifos;
+    return false;
+#endif // __linux__
+  }
+
+  void enable() const { command("enable\n"); }
+  void disable() const { command("disable\n"); }
+
+private:
+  void command(std::string const& message) const {
+#ifdef __linux__
+    if(controlFd < 0 || ::write(controlFd, message.data(), message.size()) < 0) {
+      return;
+    }
+    // perf acknowledges with "ack\n" once the events are enabled/disabled
+    char ack[4];
+    for(size_t received = 0; ackFd >= 0 && received < sizeof(ack);) {
+      auto bytes = ::read(ackFd, ack + received, sizeof(ack) - received);
+      if(bytes <= 0 && errno != EINTR) {
+        break;
+      }
+      received += bytes > 0 ? static_cast<size_t>(bytes) : 0;
+    }
+#else
+    (void)message;
+#endif // __linux__
+  }
+
+  void close() {
+#ifdef __linux__
+    if(controlFd >= 0) {
+      ::close(controlFd);
+    }
+    if(ackFd >= 0) {
+      ::close(ackFd);
+    }
+#endif // __linux__
+    controlFd = -1;
+    ackFd = -1;
+  }
+};
+
+// SIGPROF-based stack sampler: while sampling, the process' CPU time timer interrupts whichever
+// thread is running (including the engines' worker threads) and records its stack. On stop, the
+// stacks are symbolised and appended to a folded-stacks file (one "<task>;<frame>;... <count>"
+// line per distinct stack, the format of flamegraph.pl and speedscope).
+class StackSampler {
+  static constexpr int MAX_FRAMES = 48;
+  static constexpr size_t MAX_SAMPLES = size_t(1) << 16U;
+  static constexpr int SKIPPED_FRAMES = 2; // the signal handler and the signal trampoline
+
+  struct Sample {
+    std::atomic<bool> written;
+    int depth;
+    void* frames[MAX_FRAMES];
+  };
+
+  std::string outputPath;
+  int frequency = 0;
+  std::string taskname;
+  std::unique_ptr<Sample[]> samples;
+  std::atomic<size_t> numSamples = 0;
+  std::map<void*, std::string> symbols;
+
+  static inline std::atomic<StackSampler*> activeSampler = nullptr;
+
+public:
+  StackSampler() = default;
+  StackSampler(StackSampler const&) = delete;
+  StackSampler& operator=(StackSampler const&) = delete;
+  ~StackSampler() { stop(); }
+
+  bool open(std::string path, int samplesPerSecond) {
+#ifdef __linux__
+    outputPath = std::move(path);
+    frequency = std::max(1, samplesPerSecond);
+    samples = std::make_unique<Sample[]>(MAX_SAMPLES);
+    if(!std::ofstream(outputPath, std::ios::trunc).good()) {
+      return false;
+    }
+    // the first backtrace() loads the unwinder, which must not happen in the signal handler
+    void* frames[1];
+    backtrace(frames, 1);
+    struct sigaction action {};
+    action.sa_handler = &StackSampler::handleSignal; // NOLINT
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    return sigaction(SIGPROF, &action, nullptr) == 0;
+#else
+    (void)path;
+    (void)samplesPerSecond;
+    return false;
+#endif // __linux__
+  }
+
+  void start(std::string task) {
+#ifdef __linux__
+    taskname = std::move(task);
+    for(size_t i = 0; i < std::min(numSamples.load(), MAX_SAMPLES); ++i) {
+      samples[i].written.store(false, std::memory_order_relaxed);
+    }
+    numSamples = 0;
+    activeSampler = this;
+    auto microseconds = std::max(1, 1000000 / frequency);
+    auto interval = timeval{microseconds / 1000000, microseconds % 1000000};
+    itimerval timer{interval, interval};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+#else
+    (void)task;
+#endif // __linux__
+  }
+
+  void stop() {
+#ifdef __linux__
+    if(activeSampler != this) {
+      return;
+    }
+    itimerval timer{};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    activeSampler = nullptr;
+    writeFoldedStacks();
+#endif // __linux__
+  }
+
+private:
+#ifdef __linux__
+  static void handleSignal(int /*signal*/) {
+    auto savedErrno = errno;
+    auto* sampler = activeSampler.load(std::memory_order_relaxed);
+    if(sampler != nullptr) {
+      auto i = sampler->numSamples.fetch_add(1, std::memory_order_relaxed);
+      if(i < MAX_SAMPLES) {
+        auto& sample = sampler->samples[i];
+        sample.depth = backtrace(sample.frames, MAX_FRAMES);
+        sample.written.store(true, std::memory_order_release);
+      }
+    }
+    errno = savedErrno;
+  }
+
+  std::string const& symbolName(void* address) {
+    auto it = symbols.find(address);
+    if(it != symbols.end()) {
+      return it->second;
+    }
+    std::ostringstream name;
+    Dl_info info{};
+    if(dladdr(address, &info) != 0 && info.dli_sname != nullptr) {
+      int status = 0;
+      std::unique_ptr<char, decltype(&std::free)> demangled(
+          abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free);
+      name << (status == 0 ? demangled.get() : info.dli_sname);
+    } else if(info.dli_fname != nullptr) {
+      std::string module = info.dli_fname;
+      name << module.substr(module.find_last_of('/') + 1) << "+0x" << std::hex
+           << (reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(info.dli_fbase));
+    } else {
+      name << address;
+    }
+    return symbols.emplace(address, name.str()).first->second;
+  }
+
+  void writeFoldedStacks() {
+    auto recorded = numSamples.load();
+    std::map<std::string, size_t> stacks;
+    for(size_t i = 0; i < std::min(recorded, MAX_SAMPLES); ++i) {
+      auto const& sample = samples[i];
+      if(!sample.written.load(std::memory_order_acquire)) {
+        continue;
+      }
+      std::string stack = taskname;
+      for(int frame = sample.depth - 1; frame >= SKIPPED_FRAMES; --frame) {
+        // return addresses point past the call, so look up the calling instruction
+        auto* address = static_cast<char*>(sample.frames[frame]) - (frame > SKIPPED_FRAMES);
+        stack += ";" + symbolName(address);
+      }
+      ++stacks[stack];
+    }
+    std::ofstream output(outputPath, std::ios::app);
+    for(auto const& [stack, count] : stacks) {
+      output << stack << " " << count << "\n";
+    }
+    if(recorded > MAX_SAMPLES) {
+      std::cerr << "Warning: dropped " << recorded - MAX_SAMPLES << " stack samples of "
+                << taskname << " (lower --sampler-frequency)" << std::endl;
+    }
+  }
+#endif // __linux__
+};
+
+// Profiler control around the timed region of each benchmark, with a backend chosen at runtime:
+//   none     no profiler control
+//   itt      VTune's ITT API (only effective when built with ENABLE_PROFILING)
+//   perf     enables/disables a `perf record --control=fifo:...` session (see PerfControl)
+//   sampler  built-in SIGPROF stack sampler writing folded stacks (see StackSampler)
+class Profiler {
+public:
+  enum class Backend { NONE, ITT, PERF, SAMPLER };
+
+  Profiler() : itt("BOSS") {}
+
+  void useNone() { backend = Backend::NONE; }
+  void useITT() { backend = Backend::ITT; }
+  bool usePerf(std::string const& controlFifos) {
+    backend = perf.open(controlFifos) ? Backend::PERF : Backend::NONE;
+    return backend == Backend::PERF;
+  }
+  bool useSampler(std::string const& outputPath, int frequency) {
+    backend = sampler.open(outputPath, frequency) ? Backend::SAMPLER : Backend::NONE;
+    return backend == Backend::SAMPLER;
+  }
+
+  template <typename... DescriptorTypes>
+  void startSampling(DescriptorTypes... tasknameComponents) {
+    switch(backend) {
+    case Backend::NONE:
+      break;
+    case Backend::ITT:
+      itt.startSampling(tasknameComponents...);
+      break;
+    case Backend::PERF:
+      perf.enable();
+      break;
+    case Backend::SAMPLER: {
+      std::stringstream taskname;
+      (taskname << ... << tasknameComponents);
+      sampler.start(taskname.str());
+      break;
+    }
+    }
+  }
+
+  void stopSampling() {
+    switch(backend) {
+    case Backend::NONE:
+      break;
+    case Backend::ITT:
+      itt.stopSampling();
+      break;
+    case Backend::PERF:
+      perf.disable();
+      break;
+    case Backend::SAMPLER:
+      sampler.stop();
+      break;
+    }
+  }
+
+private:
+  Backend backend = Backend::ITT;
+  VTuneAPIInterface itt;
+  PerfControl perf;
+  StackSampler sampler;
+};
+
+#endif // PROFILERSUPPORT_H
@@ -0,0 +1,173 @@
+#ifndef TRACEEVENTSUPPORT_H
+#define TRACEEVENTSUPPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // __linux__
+
+// Timeline of the harness' phases (data set resets, generation, loading, warm-up and timed loops)
+// as a Chrome trace-event file (--trace-out), to be opened in Perfetto or chrome://tracing. Every
+// phase is a complete ("X") event on the thread that ran it (the kernel thread id on Linux, so
+// that it matches perf and top). The events are written as they end, in the JSON array format,
+// which the viewers accept even if the run is killed before the closing bracket is written.
+class TraceEvents {
+public:
+  // A phase that lasts until end() is called or the scope is left. Does nothing if the trace file
+  // is not open (when the phase starts).
+  class Scope {
+    TraceEvents* events;
+    std::string name;
+    char const* category;
+    double startMicroseconds = 0;
+    std::string arguments;
+
+  public:
+    Scope(TraceEvents* traceEvents, std::string scopeName, char const* scopeCategory)
+        : events(traceEvents->isOpen() ? traceEvents : nullptr), name(std::move(scopeName)),
+          category(scopeCategory) {
+      if(events != nullptr) {
+        startMicroseconds = events->now();
+      }
+    }
+    Scope(Scope const&) = delete;
+    Scope& operator=(Scope const&) = delete;
+    ~Scope() { end(); }
+
+    void argument(std::string const& key, int64_t value) {
+      appendArgument(key, std::to_string(value));
+    }
+    void argument(std::string const& key, std::string const& value) {
+      appendArgument(key, "\"" + escape(value) + "\"");
+    }
+
+    void end() {
+      if(events != nullptr) {
+        events->complete(name, category, startMicroseconds, events->now() - startMicroseconds,
+                         arguments);
+        events = nullptr;
+      }
+    }
+
+  private:
+    void appendArgument(std::string const& key, std::string const& jsonValue) {
+      if(events != nullptr) {
+        arguments += (arguments.empty() ? "\"" : ",\"") + escape(key) + "\":" + jsonValue;
+      }
+    }
+  };
+
+  TraceEvents() = default;
+  TraceEvents(TraceEvents const&) = delete;
+  TraceEvents& operator=(TraceEvents const&) = delete;
+  ~TraceEvents() { close(); }
+
+  bool open(std::string const& path) {
+    close();
+    std::lock_guard const lock(mutex);
+    file.open(path, std::ios::trunc);
+    if(!file.good()) {
+      return false;
+    }
+    origin = std::chrono::steady_clock::now();
+    file << "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << processId()
+         << ",\"args\":{\"name\":\"BOSS Benchmarks\"}}";
+    opened = true;
+    return true;
+  }
+
+  bool isOpen() const { return opened.load(std::memory_order_relaxed); }
+
+  void close() {
+    std::lock_guard const lock(mutex);
+    if(opened) {
+      opened = false;
+      file << "\n]\n";
+      file.close();
+    }
+  }
+
+  Scope scope(std::string name, char const* category = "harness") {
+    return {this, std::move(name), category};
+  }
+
+  // microseconds since the trace file was opened
+  double now() const {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin)
+        .count();
+  }
+
+  void complete(std::string const& name, char const* category, double startMicroseconds,
+                double durationMicroseconds, std::string const& arguments = "") {
+    auto threadId = currentThreadId();
+    std::lock_guard const lock(mutex);
+    if(!opened) {
+      return;
+    }
+    char timing[64]; // NOLINT
+    std::snprintf(timing, sizeof(timing), "\"ts\":%.3f,\"dur\":%.3f", startMicroseconds,
+                  durationMicroseconds);
+    file << ",\n{\"name\":\"" << escape(name) << "\",\"cat\":\"" << category
+         << "\",\"ph\":\"X\",\"pid\":" << processId() << ",\"tid\":" << threadId << ","
+         << timing;
+    if(!arguments.empty()) {
+      file << ",\"args\":{" << arguments << "}";
+    }
+    file << "}";
+  }
+
+private:
+  std::mutex mutex;
+  std::ofstream file;
+  std::atomic<bool> opened = false;
+  std::chrono::steady_clock::time_point origin;
+
+  static int64_t processId() {
+#ifdef __linux__
+    return static_cast<int64_t>(getpid());
+#else
+    return 0;
+#endif // __linux__
+  }
+
+  static int64_t currentThreadId() {
+#ifdef __linux__
+    thread_local auto const id = static_cast<int64_t>(syscall(SYS_gettid));
+#else
+    thread_local auto const id =
+        static_cast<int64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif // __linux__
+    return id;
+  }
+
+  static std::string escape(std::string const& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for(auto c : text) {
+      if(c == '"' || c == '\\') {
+        escaped += '\\';
+        escaped += c;
+      } else if(static_cast<unsigned char>(c) < 0x20) { // NOLINT
+        char code[8];                                    // NOLINT
+        std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+        escaped += code;
+      } else {
+        escaped += c;
+      }
+    }
+    return escaped;
+  }
+};
+
+#endif // TRACEEVENTSUPPORT_H
@@ -0,0 +1,143 @@
+#ifndef ALLOCATIONTRACKING_CPP
+#define ALLOCATIONTRACKING_CPP
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif // __GLIBC__
+
+// Process-wide memory accounting for the timed loops: the number of allocations and the bytes
+// they allocate (counted by the malloc family below, which the Benchmarks binary interposes for
+// itself, the engine libraries and operator new, while --track-allocations is set) as well as the
+// page faults (from getrusage) and the current and peak RSS (from /proc/self). The peak RSS is
+// the process' high-water mark, which resetPeakRSS lowers to the current RSS, so that it can be
+// attributed to a single timed loop.
+namespace allocationTracking {
+
+inline std::atomic<bool> enabled = false;
+inline std::atomic<uint64_t> numAllocations = 0;
+inline std::atomic<uint64_t> bytesAllocated = 0;
+
+struct Snapshot {
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+  int64_t minorFaults = 0;
+  int64_t majorFaults = 0;
+  int64_t rssBytes = 0;
+  int64_t peakRSSBytes = 0;
+};
+
+// Resets the peak RSS to the current RSS (Linux 4.0+), returns false if it cannot be reset
+static bool resetPeakRSS() {
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  clearRefs << "5";
+  clearRefs.flush();
+  return clearRefs.good();
+}
+
+static Snapshot snapshot() {
+  Snapshot snapshot;
+  snapshot.allocations = numAllocations.load(std::memory_order_relaxed);
+  snapshot.bytes = bytesAllocated.load(std::memory_order_relaxed);
+  rusage usage{};
+  if(getrusage(RUSAGE_SELF, &usage) == 0) {
+    snapshot.minorFaults = usage.ru_minflt;
+    snapshot.majorFaults = usage.ru_majflt;
+    snapshot.peakRSSBytes = static_cast<int64_t>(usage.ru_maxrss) * 1024; // NOLINT: in KiB
+  }
+  int64_t size = 0;
+  int64_t residentPages = 0;
+  if(std::ifstream("/proc/self/statm") >> size >> residentPages) {
+    snapshot.rssBytes = residentPages * sysconf(_SC_PAGESIZE);
+  }
+  std::ifstream status("/proc/self/status");
+  for(std::string key; status >> key;) {
+    if(key == "VmHWM:") {
+      int64_t kibibytes = 0;
+      if(status >> kibibytes) {
+        snapshot.peakRSSBytes = kibibytes * 1024; // NOLINT: unlike ru_maxrss, lowered by reset
+      }
+      break;
+    }
+  }
+  return snapshot;
+}
+
+inline void recordAllocation(size_t bytes) {
+  if(enabled.load(std::memory_order_relaxed)) {
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+    bytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+  }
+}
+
+} // namespace allocationTracking
+
+// glibc exports its allocator under __libc_* names, so the interposed functions only need to
+// count and forward (free is not interposed). Sanitizer builds bring their own interceptors.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+extern "C" {
+void* __libc_malloc(size_t size);                     // NOLINT
+void* __libc_calloc(size_t count, size_t size);       // NOLINT
+void* __libc_realloc(void* pointer, size_t size);     // NOLINT
+void* __libc_memalign(size_t alignment, size_t size); // NOLINT
+
+void* malloc(size_t size) noexcept {
+  auto* pointer = __libc_malloc(size);
+  if(pointer != nullptr) {
+    allocationTracking::recordAllocation(size);
+  }
+  return pointer;
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+  auto* pointer = __libc_calloc(count, size);
+  if(pointer != nullptr) {
+    allocationTracking::recordAllocation(count * size);
+  }
+  return pointer;
+}
+
+// counted as an allocation of the bytes the block grows by (all of them for a new block)
+void* realloc(void* pointer, size_t size) noexcept {
+  auto previousSize = pointer != nullptr ? malloc_usable_size(pointer) : 0;
+  auto* reallocated = __libc_realloc(pointer, size);
+  if(reallocated != nullptr) {
+    allocationTracking::recordAllocation(size > previousSize ? size - previousSize : 0);
+  }
+  return reallocated;
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+  auto* pointer = __libc_memalign(alignment, size);
+  if(pointer != nullptr) {
+    allocationTracking::recordAllocation(size);
+  }
+  return pointer;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept { return memalign(alignment, size); }
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept {
+  if(alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  auto* allocated = memalign(alignment, size);
+  if(allocated == nullptr && size != 0) {
+    return ENOMEM;
+  }
+  *pointer = allocated;
+  return 0;
+}
+}
+#endif // __GLIBC__
+
+#endif // ALLOCATIONTRACKING_CPP
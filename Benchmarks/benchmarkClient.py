@@ -0,0 +1,27 @@
+import socket
+import sys
+
+# Thin client of the Benchmarks daemon (started with --daemon <socket>): submits a job and prints
+# the JSON report, e.g.
+#   python3 benchmarkClient.py /tmp/boss.sock 'TPCH_Q6/1000MB' 3 > build/raw_results/result.json
+#   python3 benchmarkClient.py /tmp/boss.sock --shutdown
+
+if len(sys.argv) < 3:
+    print("Usage: python benchmarkClient.py <socket> <benchmark filter regex> [repetitions]")
+    print("       python benchmarkClient.py <socket> --shutdown")
+    sys.exit(1)
+
+if sys.argv[2] == '--shutdown':
+    job = 'shutdown'
+else:
+    repetitions = sys.argv[3] if len(sys.argv) > 3 else '1'
+    job = f'run {repetitions} {sys.argv[2]}'
+
+with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as connection:
+    connection.connect(sys.argv[1])
+    connection.sendall((job + '\n').encode())
+    report = b''
+    while chunk := connection.recv(65536):
+        report += chunk
+
+print(report.decode(), end='')
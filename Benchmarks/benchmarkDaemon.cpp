@@ -0,0 +1,160 @@
+#ifndef BENCHMARKDAEMON_CPP
+#define BENCHMARKDAEMON_CPP
+
+#include "config.hpp"
+#include "dataSetPrefetching.cpp"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cerrno>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Daemon mode (--daemon <socket>): instead of running the benchmarks once, the harness serves
+// benchmark jobs on a Unix socket, one connection per job and one job at a time. The engines and
+// the latest data set stay loaded between jobs, so that the jobs on the same data set skip its
+// initStorageEngine_*. A job is a single line, either
+//   run <repetitions> <benchmark filter regex>
+// which runs the matching benchmarks (of those registered by the daemon's command line) and
+// answers with Google Benchmark's JSON report, or
+//   shutdown
+// which stops the daemon (releasing the engines). See benchmarkClient.py for a client. A client
+// that does not send its job within JOB_READ_TIMEOUT_SECONDS is rejected, so that it cannot block
+// the daemon.
+namespace benchmarkDaemon {
+
+constexpr int JOB_READ_TIMEOUT_SECONDS = 10;
+
+// false if the connection failed or timed out (see SO_RCVTIMEO) before a complete line was read
+// (the client closing the connection ends the line, too)
+static bool readLine(int connection, std::string& line) {
+  line.clear();
+  char c = 0;
+  while(true) {
+    auto bytesRead = read(connection, &c, 1);
+    if(bytesRead < 0 && errno == EINTR) {
+      continue;
+    }
+    if(bytesRead < 0) {
+      return false;
+    }
+    if(bytesRead == 0) {
+      return !line.empty();
+    }
+    if(c == '\n') {
+      return true;
+    }
+    line += c;
+  }
+}
+
+static void writeAll(int connection, std::string const& text) {
+  size_t written = 0;
+  while(written < text.size()) {
+    auto bytesWritten =
+        send(connection, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+    if(bytesWritten < 0 && errno == EINTR) {
+      continue;
+    }
+    if(bytesWritten <= 0) {
+      return; // the client went away
+    }
+    written += static_cast<size_t>(bytesWritten);
+  }
+}
+
+// the JSON report of the benchmarks matching filter (empty if none does)
+static std::string runJob(std::string const& filter, int repetitions,
+                          std::vector<benchmark::internal::Benchmark*> const& benchmarks,
+                          DataSetPrefetcher& prefetcher) {
+  auto traceScope = traceEvents.scope("daemon job");
+  traceScope.argument("filter", filter);
+  for(auto* registered : benchmarks) {
+    registered->Repetitions(repetitions);
+  }
+  std::ostringstream report;
+  benchmark::JSONReporter reporter;
+  reporter.SetOutputStream(&report);
+  reporter.SetErrorStream(&std::cerr);
+  prefetcher.restart();
+  benchmark::RunSpecifiedBenchmarks(&reporter, filter);
+  return report.str();
+}
+
+static void serve(std::string const& socketPath,
+                  std::vector<benchmark::internal::Benchmark*> const& benchmarks,
+                  DataSetPrefetcher& prefetcher) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if(socketPath.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Error: the daemon socket path " << socketPath << " is too long" << std::endl;
+    return;
+  }
+  std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+
+  unlink(socketPath.c_str()); // left behind by a daemon that was killed
+  auto listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if(listener < 0 ||
+     bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || // NOLINT
+     listen(listener, SOMAXCONN) != 0) {
+    std::cerr << "Error: unable to listen on " << socketPath << std::endl;
+    if(listener >= 0) {
+      close(listener);
+    }
+    return;
+  }
+  std::cerr << "Serving benchmark jobs on " << socketPath << std::endl;
+
+  bool running = true;
+  while(running) {
+    auto connection = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    if(connection < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      std::cerr << "Error: unable to accept a benchmark job on " << socketPath << std::endl;
+      break;
+    }
+    timeval timeout{JOB_READ_TIMEOUT_SECONDS, 0};
+    setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::string line;
+    if(!readLine(connection, line)) {
+      std::cerr << "Warning: rejected a benchmark job that was not received" << std::endl;
+      writeAll(connection, "{\"error\": \"no job received\"}\n");
+      close(connection);
+      continue;
+    }
+    std::istringstream job(line);
+    std::string command;
+    job >> command;
+    if(command == "run") {
+      int repetitions = 1;
+      std::string filter;
+      job >> repetitions;
+      std::getline(job >> std::ws, filter);
+      std::cerr << "Running benchmark job: " << line << std::endl;
+      auto report = runJob(filter.empty() ? "." : filter, std::max(1, repetitions), benchmarks,
+                           prefetcher);
+      writeAll(connection,
+               report.empty() ? "{\"error\": \"no benchmark matches the filter\"}\n" : report);
+    } else if(command == "shutdown") {
+      writeAll(connection, "{\"shutdown\": true}\n");
+      running = false;
+    } else {
+      writeAll(connection, "{\"error\": \"unknown command, expected run or shutdown\"}\n");
+    }
+    close(connection);
+  }
+  close(listener);
+  unlink(socketPath.c_str());
+}
+
+} // namespace benchmarkDaemon
+
+#endif // BENCHMARKDAEMON_CPP
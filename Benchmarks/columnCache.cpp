@@ -0,0 +1,432 @@
+#ifndef COLUMNCACHE_CPP
+#define COLUMNCACHE_CPP
+
+#include "utilities.cpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Persistent binary columnar cache of loaded tables. A cached table is a directory with one file
+// per column and a manifest:
+//   manifest         "rows <n>", "source <tag>", then one "column <name> <type>" line per column
+//   <column>.bin     int32/int64/double: the n values, starting at offset 0 (page-aligned when
+//                    mapped); string: n + 1 uint64 offsets followed by the characters
+// Numeric columns are memory-mapped (copy-on-write) straight into the spans handed to the engine,
+// string columns are materialised; both are read in partitions of utilities::LOAD_PARTITION_ROWS.
+// A table is written to a temporary sibling directory (manifest last) and then renamed into
+// place, so the files of a published table are never modified: a replaced table's files are only
+// unlinked, which keeps them valid for the processes that still have them mapped. Readers open
+// the table directory once and read the manifest and columns relative to it, so they never mix
+// the files of two versions.
+namespace columnCache {
+
+using SpanArgument = boss::DefaultExpressionSystem::ExpressionSpanArgument;
+using SpanArguments = boss::DefaultExpressionSystem::ExpressionSpanArguments;
+
+constexpr size_t STRING_COLUMN_CHUNK_SIZE = 1 << 16;
+
+template <typename T> constexpr char const* typeName() {
+  if constexpr(std::is_same_v<T, int32_t>) {
+    return "int32";
+  } else if constexpr(std::is_same_v<T, int64_t>) {
+    return "int64";
+  } else if constexpr(std::is_same_v<T, double_t>) {
+    return "double";
+  } else if constexpr(std::is_same_v<T, std::string>) {
+    return "string";
+  } else {
+    return nullptr;
+  }
+}
+
+// Tag identifying a file by its size and mtime
+static std::string fileSourceTag(std::string const& filepath) {
+  struct stat fileStatus {};
+  if(stat(filepath.c_str(), &fileStatus) != 0) {
+    return "missing";
+  }
+  return std::to_string(fileStatus.st_size) + ":" + std::to_string(fileStatus.st_mtim.tv_sec) +
+         "." + std::to_string(fileStatus.st_mtim.tv_nsec);
+}
+
+// Tag identifying the source of a cached table: its file, the engine library that it is loaded
+// into (a rebuilt or another engine may store the columns differently) and the engine-dependent
+// encoding of its values (e.g. of dates), as a single manifest token
+static std::string tableSourceTag(std::string const& filepath, std::string const& engineLibrary,
+                                  std::string const& encoding) {
+  auto tag = fileSourceTag(filepath) + "|engine=" + engineLibrary + ":" +
+             fileSourceTag(engineLibrary) + "|" + encoding;
+  std::replace_if(
+      tag.begin(), tag.end(), [](unsigned char c) { return std::isspace(c) != 0; }, '_');
+  return tag;
+}
+
+static bool writeFile(std::string const& path, void const* data, size_t bytes) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(static_cast<char const*>(data), static_cast<std::streamsize>(bytes));
+  return file.good();
+}
+
+template <typename T>
+static bool writeColumn(std::string const& path, std::vector<SpanArgument const*> const& spans) {
+  if constexpr(std::is_same_v<T, std::string>) {
+    std::vector<uint64_t> offsets = {0};
+    for(auto const* span : spans) {
+      std::visit(
+          [&offsets]<typename U>(boss::Span<U> const& typedSpan) {
+            for(auto const& value : typedSpan) {
+              if constexpr(std::is_same_v<std::remove_const_t<U>, std::string>) {
+                offsets.push_back(offsets.back() + value.size());
+              }
+            }
+          },
+          *span);
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<char const*>(offsets.data()),
+               static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+    for(auto const* span : spans) {
+      std::visit(
+          [&file]<typename U>(boss::Span<U> const& typedSpan) {
+            for(auto const& value : typedSpan) {
+              if constexpr(std::is_same_v<std::remove_const_t<U>, std::string>) {
+                file.write(value.data(), static_cast<std::streamsize>(value.size()));
+              }
+            }
+          },
+          *span);
+    }
+    return file.good();
+  } else {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for(auto const* span : spans) {
+      std::visit(
+          [&file]<typename U>(boss::Span<U> const& typedSpan) {
+            if constexpr(std::is_same_v<std::remove_const_t<U>, T>) {
+              file.write(reinterpret_cast<char const*>(typedSpan.begin()),
+                         static_cast<std::streamsize>(typedSpan.size() * sizeof(T)));
+            }
+          },
+          *span);
+    }
+    return file.good();
+  }
+}
+
+// Publishes the table written to temporary as directory: swaps the two directories atomically
+// (or, where that is not supported, moves the replaced one aside first, so that readers briefly
+// see a cache miss) and then removes the replaced table
+static bool publishTable(std::string const& temporary, std::string const& directory) {
+  std::error_code error;
+  if(rename(temporary.c_str(), directory.c_str()) == 0) {
+    return true;
+  }
+  if(renameat2(AT_FDCWD, temporary.c_str(), AT_FDCWD, directory.c_str(), RENAME_EXCHANGE) == 0) {
+    std::filesystem::remove_all(temporary, error);
+    return true;
+  }
+  auto replaced = temporary + ".replaced";
+  auto published = rename(directory.c_str(), replaced.c_str()) == 0 &&
+                   rename(temporary.c_str(), directory.c_str()) == 0;
+  std::filesystem::remove_all(replaced, error);
+  if(!published) {
+    std::filesystem::remove_all(temporary, error);
+  }
+  return published;
+}
+
+// Writes the column files and (last) the manifest of a table to directory
+static bool writeTableFiles(std::string const& directory, boss::Expression const& table,
+                            std::string const& sourceTag) {
+  auto const* tableExpression = std::get_if<boss::ComplexExpression>(&table);
+  if(tableExpression == nullptr) {
+    return false;
+  }
+
+  std::ostringstream manifest;
+  std::optional<size_t> numRows;
+  for(auto const& column : tableExpression->getDynamicArguments()) {
+    auto const* columnExpression = std::get_if<boss::ComplexExpression>(&column);
+    if(columnExpression == nullptr || columnExpression->getDynamicArguments().empty()) {
+      return false;
+    }
+    auto const& name = columnExpression->getHead().getName();
+    auto const& list =
+        std::get<boss::ComplexExpression>(columnExpression->getDynamicArguments()[0]);
+
+    std::vector<SpanArgument const*> spans;
+    size_t rows = 0;
+    std::string type;
+    bool supported = !list.getSpanArguments().empty();
+    for(auto const& span : list.getSpanArguments()) {
+      std::visit(
+          [&]<typename T>(boss::Span<T> const& typedSpan) {
+            char const* spanType = typeName<std::remove_const_t<T>>();
+            supported &= spanType != nullptr && (spans.empty() || type == spanType);
+            type = spanType != nullptr ? spanType : "";
+            rows += typedSpan.size();
+          },
+          span);
+      spans.push_back(&span);
+    }
+    if(!supported || (numRows && *numRows != rows)) {
+      return false; // unsupported (or mixed) column type, or inconsistent table
+    }
+    numRows = rows;
+
+    auto path = directory + "/" + name + ".bin";
+    bool written = false;
+    if(type == "int32") {
+      written = writeColumn<int32_t>(path, spans);
+    } else if(type == "int64") {
+      written = writeColumn<int64_t>(path, spans);
+    } else if(type == "double") {
+      written = writeColumn<double_t>(path, spans);
+    } else {
+      written = writeColumn<std::string>(path, spans);
+    }
+    if(!written) {
+      return false;
+    }
+    manifest << "column " << name << " " << type << "\n";
+  }
+
+  std::string header =
+      "rows " + std::to_string(numRows.value_or(0)) + "\nsource " + sourceTag + "\n";
+  auto manifestContent = header + manifest.str();
+  return writeFile(directory + "/manifest", manifestContent.data(), manifestContent.size());
+}
+
+// Removes the temporary siblings of directory that were left by writers which no longer run
+// (e.g. that were killed while writing a large table)
+static void removeAbandonedTemporaries(std::string const& directory) {
+  auto path = std::filesystem::path(directory);
+  auto prefix = path.filename().string() + ".tmp.";
+  std::vector<std::filesystem::path> abandoned;
+  std::error_code error;
+  for(auto const& entry : std::filesystem::directory_iterator(path.parent_path(), error)) {
+    auto name = entry.path().filename().string();
+    if(name.rfind(prefix, 0) != 0) {
+      continue;
+    }
+    auto pid = std::atoi(name.c_str() + prefix.size());
+    if(pid > 0 && kill(pid, 0) != 0 && errno == ESRCH) {
+      abandoned.push_back(entry.path());
+    }
+  }
+  for(auto const& temporary : abandoned) {
+    std::filesystem::remove_all(temporary, error);
+  }
+}
+
+// Writes a "Table"-like expression (columns of the form name("List"_(spans...))) to a temporary
+// sibling of directory and publishes it as directory
+static bool writeTable(std::string const& directory, boss::Expression const& table,
+                       std::string const& sourceTag) {
+  removeAbandonedTemporaries(directory);
+  static std::atomic<int> temporaryCount = 0;
+  auto temporary =
+      directory + ".tmp." + std::to_string(getpid()) + "." + std::to_string(temporaryCount++);
+  std::error_code error;
+  std::filesystem::create_directories(temporary, error);
+  if(error || !writeTableFiles(temporary, table, sourceTag)) {
+    std::filesystem::remove_all(temporary, error);
+    return false;
+  }
+  return publishTable(temporary, directory);
+}
+
+// Maps a column file copy-on-write (so that engines may still modify the data), as one span per
+// partition of utilities::LOAD_PARTITION_ROWS rows (each unmapping its own page-aligned range)
+template <typename T>
+static std::optional<SpanArguments> mapColumn(int directoryFd, std::string const& file,
+                                              size_t rows) {
+  SpanArguments partitions;
+  auto bytes = rows * sizeof(T);
+  if(bytes == 0) {
+    partitions.emplace_back(boss::Span<T>(std::vector<T>()));
+    return partitions;
+  }
+  auto fd = openat(directoryFd, file.c_str(), O_RDONLY);
+  if(fd < 0) {
+    return {};
+  }
+  struct stat fileStatus {};
+  if(fstat(fd, &fileStatus) != 0 || static_cast<size_t>(fileStatus.st_size) != bytes) {
+    close(fd);
+    return {};
+  }
+  auto* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(mapped == MAP_FAILED) {
+    return {};
+  }
+  for(size_t begin = 0; begin < rows; begin += utilities::LOAD_PARTITION_ROWS) {
+    auto partitionRows = std::min(rows - begin, utilities::LOAD_PARTITION_ROWS);
+    auto* partition = static_cast<T*>(mapped) + begin;
+    partitions.emplace_back(boss::Span<T>(partition, partitionRows, [partition, partitionRows]() {
+      munmap(partition, partitionRows * sizeof(T));
+    }));
+  }
+  return partitions;
+}
+
+static std::optional<SpanArguments> readStringColumn(int directoryFd, std::string const& file,
+                                                     size_t rows) {
+  auto offsetsBytes = (rows + 1) * sizeof(uint64_t);
+  auto fd = openat(directoryFd, file.c_str(), O_RDONLY);
+  if(fd < 0) {
+    return {};
+  }
+  struct stat fileStatus {};
+  if(fstat(fd, &fileStatus) != 0 || static_cast<size_t>(fileStatus.st_size) < offsetsBytes) {
+    close(fd);
+    return {};
+  }
+  auto bytes = static_cast<size_t>(fileStatus.st_size);
+  auto* mapped = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(mapped == MAP_FAILED) {
+    return {};
+  }
+  auto const* offsets = static_cast<uint64_t const*>(mapped);
+  auto const* characters = static_cast<char const*>(mapped) + offsetsBytes;
+  if(offsetsBytes + offsets[rows] != bytes) {
+    munmap(mapped, bytes);
+    return {};
+  }
+  std::vector<std::vector<std::string>> partitions;
+  for(size_t begin = 0; begin < std::max<size_t>(rows, 1);
+      begin += utilities::LOAD_PARTITION_ROWS) {
+    partitions.emplace_back(std::min(rows - begin, utilities::LOAD_PARTITION_ROWS));
+  }
+  utilities::parallelForChunks(rows, STRING_COLUMN_CHUNK_SIZE, [&](size_t begin, size_t end) {
+    for(auto i = begin; i < end; ++i) {
+      partitions[i / utilities::LOAD_PARTITION_ROWS][i % utilities::LOAD_PARTITION_ROWS].assign(
+          characters + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+  });
+  munmap(mapped, bytes);
+  SpanArguments spans;
+  for(auto& partition : partitions) {
+    spans.emplace_back(boss::Span<std::string>(std::move(partition)));
+  }
+  return spans;
+}
+
+static std::optional<boss::ExpressionArguments> readTableAt(int directoryFd,
+                                                            std::string const& sourceTag) {
+  auto manifestFd = openat(directoryFd, "manifest", O_RDONLY);
+  if(manifestFd < 0) {
+    return {};
+  }
+  std::string content;
+  char buffer[4096];
+  for(ssize_t bytes = 0; (bytes = read(manifestFd, buffer, sizeof(buffer))) > 0;) {
+    content.append(buffer, bytes);
+  }
+  close(manifestFd);
+
+  std::istringstream manifest(content);
+  std::string key;
+  size_t rows = 0;
+  std::string source;
+  if(!(manifest >> key >> rows) || key != "rows" || !(manifest >> key >> source) ||
+     key != "source" || source != sourceTag) {
+    return {};
+  }
+
+  boss::ExpressionArguments columns;
+  std::string name;
+  std::string type;
+  while(manifest >> key >> name >> type) {
+    auto file = name + ".bin";
+    std::optional<SpanArguments> spans;
+    if(type == "int32") {
+      spans = mapColumn<int32_t>(directoryFd, file, rows);
+    } else if(type == "int64") {
+      spans = mapColumn<int64_t>(directoryFd, file, rows);
+    } else if(type == "double") {
+      spans = mapColumn<double_t>(directoryFd, file, rows);
+    } else if(type == "string") {
+      spans = readStringColumn(directoryFd, file, rows);
+    }
+    if(!spans) {
+      return {};
+    }
+    boss::ExpressionArguments list;
+    list.emplace_back(boss::ComplexExpression("List"_, {}, {}, std::move(*spans)));
+    columns.emplace_back(boss::ComplexExpression(boss::Symbol(name), {}, std::move(list), {}));
+  }
+  if(columns.empty()) {
+    return {};
+  }
+  return columns;
+}
+
+// Reads a table written by writeTable (if it exists and matches sourceTag) as the columns of a
+// "Data"_ expression for LoadDataTable
+static std::optional<boss::ExpressionArguments> readTable(std::string const& directory,
+                                                          std::string const& sourceTag) {
+  auto directoryFd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+  if(directoryFd < 0) {
+    return {};
+  }
+  auto columns = readTableAt(directoryFd, sourceTag);
+  close(directoryFd);
+  return columns;
+}
+
+// Cache of generated (synthetic) columns, shared across processes and data sets: every column is
+// a single-column table in SYNTHETIC_DATA_DIRECTORY/<key>, where the key identifies the generator
+// with all its parameters (including the seed) and doubles as the source tag. Returns the cached
+// column's spans if it exists and otherwise generate()'s span, after writing it to the cache.
+constexpr char const* SYNTHETIC_DATA_DIRECTORY = "../data/synthetic_cache";
+
+template <typename Generate>
+static SpanArguments cachedSyntheticColumn(std::string const& key, Generate&& generate) {
+  auto directory = std::string(SYNTHETIC_DATA_DIRECTORY) + "/" + key;
+  if(!DISABLE_COLUMN_CACHE) {
+    if(auto columns = readTable(directory, key)) {
+      auto [head, unused_, dynamics, spans] =
+          std::get<boss::ComplexExpression>(std::move(columns->front())).decompose();
+      auto [listHead, listUnused_, listDynamics, listSpans] =
+          std::get<boss::ComplexExpression>(std::move(dynamics.front())).decompose();
+      return std::move(listSpans);
+    }
+  }
+
+  SpanArguments spans;
+  spans.emplace_back(generate());
+  if(!DISABLE_COLUMN_CACHE) {
+    SpanArguments cachedSpans;
+    cachedSpans.emplace_back(utilities::shallowCopy(spans.front()));
+    boss::ExpressionArguments list;
+    boss::ExpressionArguments columns;
+    list.emplace_back(boss::ComplexExpression("List"_, {}, {}, std::move(cachedSpans)));
+    columns.emplace_back(boss::ComplexExpression("column"_, {}, std::move(list), {}));
+    if(!writeTable(directory, boss::ComplexExpression("Table"_, {}, std::move(columns), {}), key)) {
+      std::cerr << "Warning: unable to write the synthetic data cache " << directory << std::endl;
+    }
+  }
+  return spans;
+}
+
+} // namespace columnCache
+
+#endif // COLUMNCACHE_CPP
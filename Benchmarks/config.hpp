@@ -1,21 +1,33 @@
 #ifndef BOSSBENCHMARKS_CONFIG_HPP
 #define BOSSBENCHMARKS_CONFIG_HPP
 
-#include "ITTNotifySupport.hpp"
+#include "NumaSupport.hpp"
+#include "PerfEventSupport.hpp"
+#include "ProfilerSupport.hpp"
+#include "TraceEventSupport.hpp"
 
-extern VTuneAPIInterface vtune;
+extern Profiler profiler;
+extern PerfEventCounters perfCounters;
+extern TraceEvents traceEvents;
 
 extern bool VERBOSE_QUERY_OUTPUT;
 extern bool VERY_VERBOSE_QUERY_OUTPUT;
 extern bool ENABLE_CONSTRAINTS;
+extern bool DISABLE_COLUMN_CACHE;
+extern bool DISABLE_PARALLEL_LOAD;
+extern bool HARNESS_TBL_PARSING; // .tbl files are parsed by the harness instead of the engine
+extern bool DISPATCH_FLOOR;   // queries run against the no-op engine, without loading any data
+extern bool PREPARED_QUERIES; // query building and result teardown are excluded from the timing
 extern int BENCHMARK_NUM_WARMPUP_ITERATIONS;
+extern int NUM_DATA_GENERATION_THREADS;    // 0 = use all hardware threads
+extern int64_t SELECT_NUM_TUPLES;          // rows of the synthetic select datasets
+extern double MEMORY_READ_BANDWIDTH;       // bytes/s, measured at startup (0 = not measured)
+extern std::string LATENCY_DUMP_DIRECTORY; // raw per-iteration latencies (empty = not dumped)
 
 extern std::vector<std::string> librariesToTest;
-extern int latestDataSize; // Scale factor for TPCH and num of elements for custom
+extern int64_t latestDataSize; // Scale factor for TPCH and num of elements for custom
 extern std::string latestDataSet;
 
-extern int googleBenchmarkApplyParameterHelper;
-
 enum DATASETS { TPCH = 0, CUSTOM = 100 };
 
 #endif // BOSSBENCHMARKS_CONFIG_HPP
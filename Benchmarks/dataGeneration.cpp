@@ -5,8 +5,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
 #include <random>
-#include <set>
 #include <vector>
 #include <cassert>
 
@@ -24,157 +28,276 @@ std::vector<T> generateLogDistribution(int numPoints, double minValue, double ma
   auto unique_end = std::unique(points.begin(), points.end());
   points.erase(unique_end, points.end());
 
-  if(points[points.size() - 1] != static_cast<int>(maxValue)) {
-    points[points.size() - 1] = static_cast<int>(maxValue);
+  if(points[points.size() - 1] != static_cast<T>(maxValue)) {
+    points[points.size() - 1] = static_cast<T>(maxValue);
   }
 
   return points;
 }
 
-template <typename T>
-std::vector<T> generateUniformDistribution(size_t n, T lowerBound, T upperBound) {
-  static_assert(std::is_integral<T>::value, "Must be an integer type");
-
-#if False
-  std::cout << "Generating data in memory... ";
-  std::cout.flush();
-#endif
-
-  unsigned int seed = 1;
-  std::mt19937 gen(seed);
+constexpr uint64_t DEFAULT_DATA_GENERATION_SEED = 1;
+constexpr size_t DATA_GENERATION_CHUNK_SIZE = 1 << 16;
 
-  std::uniform_int_distribution<T> distribution(lowerBound, upperBound);
+// Counter-based random number generator (splitmix64 finaliser): the value for a given counter
+// depends only on (seed, counter), so data can be generated in any order by any number of threads
+inline uint64_t counterBasedRandom(uint64_t seed, uint64_t counter) {
+  uint64_t z = seed + (counter + 1) * 0x9e3779b97f4a7c15ULL; // NOLINT
+  z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9ULL;                // NOLINT
+  z = (z ^ (z >> 27U)) * 0x94d049bb133111ebULL;                // NOLINT
+  return z ^ (z >> 31U);                                       // NOLINT
+}
 
-  std::vector<T> data;
-  data.reserve(n);
+__extension__ using uint128_t = unsigned __int128;
 
-  for(size_t i = 0; i < n; ++i) {
-    data.push_back(distribution(gen));
+// Maps a 64-bit random value to [lowerBound, upperBound] (Lemire's multiply-shift reduction)
+template <typename T> inline T boundedRandom(uint64_t random, T lowerBound, T upperBound) {
+  auto range = static_cast<uint64_t>(upperBound) - static_cast<uint64_t>(lowerBound) + 1;
+  if(range == 0) { // full 64-bit range
+    return static_cast<T>(random);
   }
-
-#if False
-  std::cout << "Complete" << std::endl;
-#endif
-  return data;
+  auto offset = static_cast<uint64_t>((static_cast<uint128_t>(random) * range) >> 64U);
+  return static_cast<T>(static_cast<uint64_t>(lowerBound) + offset);
 }
 
+// Fills data[0, n) with uniformly distributed values, e.g. directly into an engine-owned buffer
 template <typename T>
-std::vector<T> generatePartiallySortedOneToOneHundred(int n, int numRepeats,
-                                                      float percentageRandom) {
+void fillUniformDistribution(T* data, size_t n, T lowerBound, T upperBound,
+                             uint64_t seed = DEFAULT_DATA_GENERATION_SEED) {
   static_assert(std::is_integral<T>::value, "Must be an integer type");
-  assert(percentageRandom >= 0.0 && percentageRandom <= 100.0);
 
-  if (static_cast<int>(percentageRandom) == 100) {
-    return generateUniformDistribution<T>(n, 1, 100);
-  }
+  utilities::parallelForChunks(n, DATA_GENERATION_CHUNK_SIZE, [&](size_t begin, size_t end) {
+    for(size_t i = begin; i < end; ++i) {
+      data[i] = boundedRandom<T>(counterBasedRandom(seed, i), lowerBound, upperBound);
+    }
+  });
+}
 
+template <typename T>
+boss::Span<T> generateUniformDistribution(size_t n, T lowerBound, T upperBound,
+                                          uint64_t seed = DEFAULT_DATA_GENERATION_SEED) {
 #if False
   std::cout << "Generating data in memory... ";
   std::cout.flush();
 #endif
 
-  std::vector<T> data;
-  data.reserve(n);
-
-  int sectionSize = 100 * numRepeats;
-  int sections = n / (sectionSize);
-  int elementsToShufflePerSection =
-      static_cast<int>(0.5 * (percentageRandom / 100.0) * static_cast<float>(sectionSize));
+  auto data = utilities::allocateAlignedSpan<T>(n);
+  fillUniformDistribution<T>(data.begin(), n, lowerBound, upperBound, seed);
 
 #if False
-  std::cout << sectionSize << " section size" << std::endl;
-  std::cout << sections << " sections" << std::endl;
-  std::cout << elementsToShufflePerSection << " pairs to shuffle per section" << std::endl;
+  std::cout << "Complete" << std::endl;
 #endif
+  return data;
+}
 
-  unsigned int seed = 1;
-  std::mt19937 gen(seed);
+// Fills data[0, n) with sections of 100 * numRepeats values, alternately running 1 -> 100 and
+// 100 -> 1 (each value repeated numRepeats times). In every section, percentageRandom% of the
+// positions are selected (without replacement) and swapped in pairs. Each section is generated
+// in O(sectionSize) from its own counter-based seed, so sections are filled in parallel and the
+// result does not depend on the number of threads.
+template <typename T>
+void fillPartiallySortedOneToOneHundred(T* data, size_t n, size_t numRepeats,
+                                        float percentageRandom,
+                                        uint64_t seed = DEFAULT_DATA_GENERATION_SEED) {
+  static_assert(std::is_integral<T>::value, "Must be an integer type");
+  assert(percentageRandom >= 0.0 && percentageRandom <= 100.0);
+  assert(numRepeats > 0);
 
-  bool increasing = true;
   T lowerBound = 1;
   T upperBound = 100;
-
-  T value;
-  auto index = 0;
-  for(auto i = 0; i < sections; ++i) {
-    value = increasing ? lowerBound : upperBound;
-    for(auto j = 0; j < 100; ++j) {
-      for(auto k = 0; k < numRepeats; ++k) {
-        data.push_back(value);
-        ++index;
+  size_t sectionSize = 100 * numRepeats;
+  size_t sections = (n + sectionSize - 1) / sectionSize; // the last section may be partial
+  size_t sectionsPerChunk = std::max<size_t>(1, DATA_GENERATION_CHUNK_SIZE / sectionSize);
+
+  utilities::parallelForChunks(sections, sectionsPerChunk, [&](size_t begin, size_t end) {
+    std::vector<size_t> offsets(sectionSize);
+    for(size_t section = begin; section < end; ++section) {
+      auto* sectionData = data + section * sectionSize;
+      auto size = std::min(sectionSize, n - section * sectionSize);
+      bool increasing = section % 2 == 0;
+
+      T value = increasing ? lowerBound : upperBound;
+      for(size_t i = 0; i < size; i += numRepeats) {
+        std::fill_n(sectionData + i, std::min(numRepeats, size - i), value);
+        value = increasing ? value + 1 : value - 1;
       }
-      value = increasing ? value + 1 : value - 1;
-    }
-    increasing = !increasing;
-
-    std::set<int> selectedIndexes = {};
-    int index1, index2;
-    for(auto swapCount = 0; swapCount < elementsToShufflePerSection; ++swapCount) {
-      std::uniform_int_distribution<int> dis(1, sectionSize);
 
-      index1 = dis(gen);
-      while(selectedIndexes.count(index1) > 0) {
-        index1 = dis(gen);
+      // a partial Fisher-Yates shuffle of the offsets selects the positions to swap
+      auto pairsToSwap = static_cast<size_t>(0.5 * (percentageRandom / 100.0) *
+                                             static_cast<double>(size));
+      if(pairsToSwap == 0) {
+        continue;
       }
-
-      index2 = dis(gen);
-      while(selectedIndexes.count(index2) > 0) {
-        index2 = dis(gen);
+      std::iota(offsets.begin(), offsets.begin() + static_cast<std::ptrdiff_t>(size), 0);
+      auto sectionSeed = counterBasedRandom(seed, section);
+      for(size_t i = 0; i < 2 * pairsToSwap; ++i) {
+        auto j = boundedRandom<size_t>(counterBasedRandom(sectionSeed, i), i, size - 1);
+        std::swap(offsets[i], offsets[j]);
       }
+      for(size_t i = 0; i < 2 * pairsToSwap; i += 2) {
+        std::swap(sectionData[offsets[i]], sectionData[offsets[i + 1]]);
+      }
+    }
+  });
+}
 
-      selectedIndexes.insert(index1);
-      selectedIndexes.insert(index2);
-      std::swap(data[index - index1], data[index - index2]);
+template <typename T>
+boss::Span<T> generatePartiallySortedOneToOneHundred(size_t n, size_t numRepeats,
+                                                     float percentageRandom,
+                                                     uint64_t seed = DEFAULT_DATA_GENERATION_SEED) {
+  if(static_cast<int>(percentageRandom) == 100) {
+    return generateUniformDistribution<T>(n, 1, 100, seed);
+  }
 
 #if False
-      std::cout << "Swapped indexes: " << index1 << ", " << index2 << std::endl;
+  std::cout << "Generating data in memory... ";
+  std::cout.flush();
 #endif
-    }
 
-#if False
-    for(int x = 0; x < 100; ++x) {
-      for(int y = 0; y < numRepeats; ++y) {
-        std::cout << data[index - sectionSize + (x * numRepeats) + y] << std::endl;
-      }
-    }
-#endif
-  }
+  auto data = utilities::allocateAlignedSpan<T>(n);
+  fillPartiallySortedOneToOneHundred<T>(data.begin(), n, numRepeats, percentageRandom, seed);
+
 #if False
   std::cout << "Complete" << std::endl;
 #endif
   return data;
 }
 
-std::vector<uint32_t> generateClusteringOrder(int n, int spreadInCluster) {
-  uint32_t numBuckets = 1 + n - spreadInCluster;
-  std::vector<std::vector<uint32_t>> buckets(numBuckets, std::vector<uint32_t>());
+// Streams a clustered permutation of [0, n) to emit(position). Every position i is assigned to a
+// bucket drawn uniformly from [max(0, i - spreadInCluster + 1), min(i, n - spreadInCluster)] and
+// the buckets are emitted in order, each one shuffled. A position is only assigned once its first
+// eligible bucket is reached, so at most spreadInCluster positions are pending at any time: they
+// are kept in a fixed pool of linked-list nodes (one list per open bucket) and no allocation
+// happens after construction.
+template <typename Func>
+void forEachInClusteringOrder(uint64_t n, uint64_t spreadInCluster, Func&& emit,
+                              uint64_t seed = DEFAULT_DATA_GENERATION_SEED) {
+  if(n == 0) {
+    return;
+  }
+  auto spread = std::clamp<uint64_t>(spreadInCluster, 1, n);
+  auto numBuckets = 1 + n - spread;
+  auto shuffleSeed = counterBasedRandom(~seed, 0);
+
+  constexpr auto none = std::numeric_limits<uint64_t>::max();
+  std::vector<uint64_t> bucketHeads(spread, none); // open buckets, indexed by bucket % spread
+  std::vector<uint64_t> nodePositions(spread);
+  std::vector<uint64_t> nextNodes(spread);
+  std::iota(nextNodes.begin(), nextNodes.end(), 1);
+  uint64_t freeNodes = 0;
+  std::vector<uint64_t> bucket;
+
+  uint64_t nextPosition = 0;
+  for(uint64_t b = 0; b < numBuckets; ++b) {
+    // assign every position whose first eligible bucket is b
+    for(; nextPosition < b + spread; ++nextPosition) {
+      auto i = nextPosition;
+      auto lowest = i + 1 > spread ? i + 1 - spread : 0;
+      auto highest = std::min(i, n - spread);
+      auto target = boundedRandom<uint64_t>(counterBasedRandom(seed, i), lowest, highest);
+      auto node = freeNodes;
+      freeNodes = nextNodes[node];
+      nodePositions[node] = i;
+      nextNodes[node] = bucketHeads[target % spread];
+      bucketHeads[target % spread] = node;
+    }
 
-  uint32_t seed = 1;
-  std::mt19937 gen(seed);
+    bucket.clear();
+    for(auto node = bucketHeads[b % spread]; node != none;) {
+      bucket.push_back(nodePositions[node]);
+      auto next = nextNodes[node];
+      nextNodes[node] = freeNodes;
+      freeNodes = node;
+      node = next;
+    }
+    bucketHeads[b % spread] = none;
 
-  for(int i = 0; i < n; i++) {
-    std::uniform_int_distribution<uint32_t> distribution(std::max(0, 1 + i - spreadInCluster),
-                                                         std::min(i, n - spreadInCluster));
-    buckets[distribution(gen)].push_back(i);
+    for(uint64_t j = bucket.size(); j > 1; --j) {
+      auto k = boundedRandom<uint64_t>(counterBasedRandom(shuffleSeed + b, j), 0, j - 1);
+      std::swap(bucket[j - 1], bucket[k]);
+    }
+    for(auto position : bucket) {
+      emit(position);
+    }
   }
+}
 
-  std::vector<uint32_t> result;
-  for(uint32_t i = 0; i < numBuckets; i++) {
-    std::shuffle(buckets[i].begin(), buckets[i].end(), gen);
-    result.insert(result.end(), buckets[i].begin(), buckets[i].end());
-  }
+constexpr size_t GATHER_BLOCK_SIZE = 1 << 12;
+constexpr size_t GATHER_BLOCKS_PER_THREAD = 16;
+constexpr size_t GATHER_PREFETCH_DISTANCE = 16;
 
-  return result;
+// target[i] = source[positions[i]] for i in [begin, end), prefetching the upcoming random reads
+template <typename T>
+inline void gatherBlock(T const* source, T* target, uint64_t const* positions, size_t begin,
+                        size_t end) {
+  auto prefetchEnd = end > GATHER_PREFETCH_DISTANCE ? end - GATHER_PREFETCH_DISTANCE : 0;
+  size_t i = begin;
+  for(; i < prefetchEnd; ++i) {
+    __builtin_prefetch(source + positions[i + GATHER_PREFETCH_DISTANCE]);
+    target[i] = source[positions[i]];
+  }
+  for(; i < end; ++i) {
+    target[i] = source[positions[i]];
+  }
 }
 
-template <typename T>
-boss::Span<T> applyClusteringOrderToSpan(const boss::Span<T>& orderedSpan,
-                                         boss::Span<T>&& clusteredSpan,
-                                         const std::vector<uint32_t>& positions, int n) {
-  for(auto i = 0; i < n; i++) {
-    clusteredSpan[i] = orderedSpan[positions[i]];
+// Applies the clustering order of forEachInClusteringOrder(n, spreadInCluster) to many columns
+// while it is streamed, so that the order itself is never materialised: the positions are
+// buffered in batches of GATHER_BLOCKS_PER_THREAD blocks per data generation thread and every
+// batch is gathered in parallel, block by block, so each block of positions is read from memory
+// once and stays in cache for all the columns. The reads of the ordered columns are only local
+// while spreadInCluster is small: a position is read from within spreadInCluster rows of where it
+// is written, so for spreads beyond the caches the gather becomes a random read over the whole
+// column, which the prefetching only partly hides.
+// Each pair holds the ordered column and the column to rewrite (of the same type and size n).
+// String columns are copy-assigned, so their capacity is reused when a column is rewritten again.
+void applyClusteringOrderToSpans(
+    std::vector<std::pair<boss::DefaultExpressionSystem::ExpressionSpanArgument const*,
+                          boss::DefaultExpressionSystem::ExpressionSpanArgument*>> const& columns,
+    uint64_t n, uint64_t spreadInCluster) {
+  if(columns.empty()) {
+    return;
+  }
+  for(auto const& [orderedSpan, clusteredSpan] : columns) {
+    if(!std::holds_alternative<boss::Span<int64_t>>(*clusteredSpan) &&
+       !std::holds_alternative<boss::Span<int32_t>>(*clusteredSpan) &&
+       !std::holds_alternative<boss::Span<double_t>>(*clusteredSpan) &&
+       !std::holds_alternative<boss::Span<std::string>>(*clusteredSpan)) {
+      throw std::runtime_error("unsupported column type for clustering");
+    }
   }
-  return clusteredSpan;
+
+  auto batchSize = GATHER_BLOCK_SIZE * GATHER_BLOCKS_PER_THREAD *
+                   utilities::numDataGenerationThreads();
+  std::vector<uint64_t> positions;
+  positions.reserve(batchSize);
+  uint64_t batchBegin = 0;
+  auto gatherBatch = [&]() {
+    auto const* batch = positions.data();
+    auto gatherBlocks = [&](size_t begin, size_t end) {
+      for(auto const& [orderedSpan, clusteredSpan] : columns) {
+        std::visit(
+            [&]<typename T>(boss::Span<T>& target) {
+              if constexpr(std::is_same_v<T, int64_t> || std::is_same_v<T, int32_t> ||
+                           std::is_same_v<T, double_t> || std::is_same_v<T, std::string>) {
+                auto const& source = std::get<boss::Span<T>>(*orderedSpan);
+                gatherBlock(source.begin(), target.begin() + batchBegin, batch, begin, end);
+              }
+            },
+            *clusteredSpan);
+      }
+    };
+    utilities::parallelForChunks(positions.size(), GATHER_BLOCK_SIZE, gatherBlocks);
+    batchBegin += positions.size();
+    positions.clear();
+  };
+
+  forEachInClusteringOrder(n, spreadInCluster, [&](uint64_t position) {
+    positions.push_back(position);
+    if(positions.size() == batchSize) {
+      gatherBatch();
+    }
+  });
+  gatherBatch();
 }
 
 #endif // DATAGENERATION_CPP
\ No newline at end of file
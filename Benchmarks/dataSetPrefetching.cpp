@@ -0,0 +1,104 @@
+#ifndef DATASETPREFETCHING_CPP
+#define DATASETPREFETCHING_CPP
+
+#include "config.hpp"
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Reads the files of the next data set into the page cache on a background thread while the
+// benchmarks of the current one run (--prefetch-datasets), so that its initStorageEngine_* maps
+// or parses files that are already in memory. Only the I/O is overlapped (the reads are issued
+// with posix_fadvise and performed by the kernel), building the data set itself still happens in
+// order. The data sets are the groups of benchmarks in their execution order; a group's paths are
+// files or directories (prefetched recursively).
+class DataSetPrefetcher {
+  std::vector<std::vector<std::string>> groupPaths;
+  std::mutex mutex;
+  std::thread prefetching;
+  int prefetchedGroup = 0; // the first group's files are read by its own initialisation
+
+public:
+  bool enabled = false;
+
+  DataSetPrefetcher() = default;
+  DataSetPrefetcher(DataSetPrefetcher const&) = delete;
+  DataSetPrefetcher& operator=(DataSetPrefetcher const&) = delete;
+  ~DataSetPrefetcher() { wait(); }
+
+  // returns the index of the new group
+  int addGroup(std::vector<std::string> paths) {
+    groupPaths.push_back(std::move(paths));
+    return static_cast<int>(groupPaths.size()) - 1;
+  }
+
+  // called once a benchmark of group has run (and so its data set is loaded)
+  void prefetchAfter(int group) {
+    std::lock_guard const lock(mutex);
+    auto next = group + 1;
+    if(!enabled || group < 0 || next <= prefetchedGroup ||
+       next >= static_cast<int>(groupPaths.size())) {
+      return;
+    }
+    prefetchedGroup = next;
+    if(prefetching.joinable()) {
+      prefetching.join();
+    }
+    prefetching = std::thread([paths = groupPaths[next]]() {
+      auto traceScope = traceEvents.scope("prefetch", "storage");
+      for(auto const& path : paths) {
+        prefetchPath(path);
+      }
+    });
+  }
+
+  // called before every run of the benchmarks (e.g. every daemon job), which starts with the first
+  // group again
+  void restart() {
+    std::lock_guard const lock(mutex);
+    if(prefetching.joinable()) {
+      prefetching.join();
+    }
+    prefetchedGroup = 0;
+  }
+
+  void wait() {
+    std::lock_guard const lock(mutex);
+    if(prefetching.joinable()) {
+      prefetching.join();
+    }
+  }
+
+private:
+  static void prefetchFile(std::string const& path) {
+    auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+      return;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+  }
+
+  static void prefetchPath(std::string const& path) {
+    std::error_code error;
+    if(std::filesystem::is_regular_file(path, error)) {
+      prefetchFile(path);
+      return;
+    }
+    if(!std::filesystem::is_directory(path, error)) {
+      return;
+    }
+    for(auto const& entry : std::filesystem::recursive_directory_iterator(path, error)) {
+      if(entry.is_regular_file(error)) {
+        prefetchFile(entry.path().string());
+      }
+    }
+  }
+};
+
+#endif // DATASETPREFETCHING_CPP
@@ -0,0 +1,83 @@
+#ifndef LATENCYHISTOGRAM_CPP
+#define LATENCYHISTOGRAM_CPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+// HDR-style histogram of latencies in nanoseconds: values below 2^SUB_BUCKET_BITS are counted
+// exactly and larger values in 2^SUB_BUCKET_BITS linear sub-buckets per power of two, i.e. with a
+// relative error below 2^-SUB_BUCKET_BITS (0.8%). Recording is a few instructions and never
+// allocates, so it can run inside the timed loop.
+class LatencyHistogram {
+  static constexpr unsigned SUB_BUCKET_BITS = 7;
+  static constexpr uint64_t SUB_BUCKETS = uint64_t(1) << SUB_BUCKET_BITS;
+  static constexpr unsigned NUM_RANGES = 64 - SUB_BUCKET_BITS + 1;
+
+  std::array<uint64_t, NUM_RANGES * SUB_BUCKETS> counts{};
+  uint64_t numValues = 0;
+  uint64_t maxValue = 0;
+  double sumValues = 0;
+
+  // range 0 holds the values below SUB_BUCKETS, range r > 0 the values of bit width
+  // SUB_BUCKET_BITS + r
+  static size_t bucketIndex(uint64_t value) {
+    if(value < SUB_BUCKETS) {
+      return value;
+    }
+    auto range = static_cast<size_t>(std::bit_width(value)) - SUB_BUCKET_BITS;
+    return range * SUB_BUCKETS + ((value >> (range - 1)) & (SUB_BUCKETS - 1));
+  }
+
+  // the highest value that falls into a bucket
+  static uint64_t bucketValue(size_t index) {
+    auto range = index / SUB_BUCKETS;
+    auto subBucket = index % SUB_BUCKETS;
+    if(range == 0) {
+      return subBucket;
+    }
+    return ((SUB_BUCKETS | subBucket) << (range - 1)) + ((uint64_t(1) << (range - 1)) - 1);
+  }
+
+public:
+  void record(uint64_t nanoseconds) {
+    ++counts[bucketIndex(nanoseconds)];
+    ++numValues;
+    maxValue = std::max(maxValue, nanoseconds);
+    sumValues += static_cast<double>(nanoseconds);
+  }
+
+  void merge(LatencyHistogram const& other) {
+    for(size_t i = 0; i < counts.size(); ++i) {
+      counts[i] += other.counts[i];
+    }
+    numValues += other.numValues;
+    maxValue = std::max(maxValue, other.maxValue);
+    sumValues += other.sumValues;
+  }
+
+  uint64_t size() const { return numValues; }
+  uint64_t max() const { return maxValue; }
+  double mean() const { return numValues == 0 ? 0 : sumValues / static_cast<double>(numValues); }
+
+  // the (upper bound of the bucket of the) value below which percentile % of the values fall
+  uint64_t percentile(double percentile) const {
+    if(numValues == 0) {
+      return 0;
+    }
+    auto rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(percentile / 100 * static_cast<double>(numValues) + 0.5));
+    uint64_t seen = 0;
+    for(size_t i = 0; i < counts.size(); ++i) {
+      seen += counts[i];
+      if(seen >= rank) {
+        return std::min(bucketValue(i), maxValue);
+      }
+    }
+    return maxValue;
+  }
+};
+
+#endif // LATENCYHISTOGRAM_CPP
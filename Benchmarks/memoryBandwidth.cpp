@@ -0,0 +1,83 @@
+#ifndef MEMORYBANDWIDTH_CPP
+#define MEMORYBANDWIDTH_CPP
+
+#include "NumaSupport.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// STREAM-style baseline of the attainable memory bandwidth (--bandwidth-baseline), to put the
+// column bytes that each benchmark refers to per second into perspective. Both kernels run on all
+// available CPUs (i.e. those of the --numa-policy), each thread on its own (first-touched) slice
+// of arrays much larger than the caches, and the best of a few repetitions is reported:
+//   read  sum += a[i]  (8 bytes per element)
+//   copy  c[i] = a[i]  (16 bytes per element, not counting write-allocate traffic)
+namespace memoryBandwidth {
+
+constexpr size_t ARRAY_ELEMENTS = size_t(1) << 25U; // 256 MB per array
+constexpr int REPETITIONS = 5;
+
+struct Baseline {
+  double readBytesPerSecond = 0;
+  double copyBytesPerSecond = 0;
+};
+
+template <typename Kernel> static double bestSeconds(size_t numThreads, Kernel&& kernel) {
+  auto best = std::numeric_limits<double>::max();
+  for(int repetition = 0; repetition < REPETITIONS; ++repetition) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(size_t thread = 0; thread < numThreads; ++thread) {
+      threads.emplace_back(kernel, ARRAY_ELEMENTS * thread / numThreads,
+                           ARRAY_ELEMENTS * (thread + 1) / numThreads);
+    }
+    for(auto& thread : threads) {
+      thread.join();
+    }
+    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                              .count());
+  }
+  return best;
+}
+
+static Baseline measure() {
+  auto numThreads = static_cast<size_t>(numa::availableCPUs());
+  auto a = std::unique_ptr<uint64_t[]>(new uint64_t[ARRAY_ELEMENTS]);
+  auto c = std::unique_ptr<uint64_t[]>(new uint64_t[ARRAY_ELEMENTS]);
+  std::atomic<uint64_t> checksum = 0;
+
+  bestSeconds(numThreads, [&](size_t begin, size_t end) {
+    std::fill(a.get() + begin, a.get() + end, 1);
+    std::fill(c.get() + begin, c.get() + end, 0);
+  });
+  auto readSeconds = bestSeconds(numThreads, [&](size_t begin, size_t end) {
+    // independent accumulators, so that the loop is bound by the loads and not by the additions
+    uint64_t sums[4] = {0, 0, 0, 0};
+    auto i = begin;
+    for(; i + 4 <= end; i += 4) {
+      sums[0] += a[i];
+      sums[1] += a[i + 1];
+      sums[2] += a[i + 2];
+      sums[3] += a[i + 3];
+    }
+    for(; i < end; ++i) {
+      sums[0] += a[i];
+    }
+    checksum += sums[0] + sums[1] + sums[2] + sums[3]; // keeps the loop from being optimised away
+  });
+  auto copySeconds = bestSeconds(numThreads, [&](size_t begin, size_t end) {
+    std::copy(a.get() + begin, a.get() + end, c.get() + begin);
+  });
+
+  auto bytes = static_cast<double>(ARRAY_ELEMENTS * sizeof(uint64_t));
+  return {bytes / readSeconds, 2 * bytes / copySeconds};
+}
+
+} // namespace memoryBandwidth
+
+#endif // MEMORYBANDWIDTH_CPP
@@ -0,0 +1,239 @@
+#ifndef QUERYBENCHMARK_CPP
+#define QUERYBENCHMARK_CPP
+
+#include "allocationTracking.cpp"
+#include "config.hpp"
+#include "latencyHistogram.cpp"
+#include "utilities.cpp"
+#include <BOSS.hpp>
+#include <ExpressionUtilities.hpp>
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Latencies of the timed iterations of the running benchmark, one histogram (and, with
+// --latency-dump, one vector of the raw nanoseconds) per client thread (see --clients)
+static std::vector<LatencyHistogram> clientLatencies;
+static std::vector<std::vector<uint64_t>> clientRawLatencies;
+// mean latency (in seconds) of the timed iterations of the last run of runQueryBenchmark
+static double lastMeanLatency = 0;
+// full name of the benchmark run that the calling (client) thread runs, with its arguments and
+// thread count, as set by the harness (State::name() is only the benchmark's registered name)
+static thread_local std::string runningBenchmarkName;
+
+// Writes the raw latencies to <LATENCY_DUMP_DIRECTORY>/<benchmark run name>.latencies, as one
+// "<client> <nanoseconds>" line per timed iteration
+static void dumpLatencies(std::string const& benchmarkName) {
+  auto filename = benchmarkName;
+  std::replace_if(
+      filename.begin(), filename.end(),
+      [](char c) { return std::isalnum(static_cast<unsigned char>(c)) == 0 && c != '-'; }, '_');
+  std::filesystem::create_directories(LATENCY_DUMP_DIRECTORY);
+  std::ofstream dump(LATENCY_DUMP_DIRECTORY + "/" + filename + ".latencies", std::ios::trunc);
+  for(size_t client = 0; client < clientRawLatencies.size(); ++client) {
+    for(auto latency : clientRawLatencies[client]) {
+      dump << client << " " << latency << "\n";
+    }
+  }
+  if(!dump.good()) {
+    std::cerr << "Warning: unable to write the latencies of " << benchmarkName << " to "
+              << LATENCY_DUMP_DIRECTORY << std::endl;
+  }
+}
+
+// Runs a query as the timed loop of a benchmark (after the optional verbose output and the
+// warm-up iterations). With multiple client threads, every thread issues the query concurrently
+// against the same loaded tables: the data set must be initialised by thread 0 before calling
+// this (the other threads wait at the start of the timed loop), and the aggregate QPS is reported.
+// The latency percentiles (and maximum) are reported over all clients' iterations, together with
+// the mean time that an iteration spends building the query (a shallow copy), evaluating it and
+// destroying the result. With --prepared-queries, only the evaluation is timed (and recorded as
+// latency): the benchmarks use manual timing and every iteration reports its evaluation time, so
+// that building and teardown are excluded without pausing the timer twice per iteration.
+void runQueryBenchmark(benchmark::State& state, std::string const& queryName,
+                       boss::Expression const& query) {
+  auto eval = [](auto&& expression) {
+    boss::expressions::ExpressionSpanArguments spans;
+    spans.emplace_back(boss::expressions::Span<std::string>(librariesToTest));
+    return boss::evaluate("EvaluateInEngines"_(
+        boss::ComplexExpression("List"_, {}, {}, std::move(spans)), std::move(expression)));
+  };
+
+  auto error_found = [](auto&& result, auto const& queryName) {
+    if(!std::holds_alternative<boss::ComplexExpression>(result)) {
+      return false;
+    }
+    if(std::get<boss::ComplexExpression>(result).getHead() == "Table"_) {
+      return false;
+    }
+    if(std::get<boss::ComplexExpression>(result).getHead() == "List"_) {
+      return false;
+    }
+    std::cout << queryName << " Error: "
+              << (VERY_VERBOSE_QUERY_OUTPUT ? std::move(result)
+                                            : utilities::injectDebugInfoToSpans(std::move(result)))
+              << std::endl;
+    return true;
+  };
+
+  bool isFirstClient = state.thread_index() == 0;
+  bool failed = false;
+  allocationTracking::Snapshot memoryBefore;
+  bool peakRSSReset = false;
+
+  if(isFirstClient) {
+    if(VERBOSE_QUERY_OUTPUT) {
+      auto traceScope = traceEvents.scope("verbose output", "query");
+      auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
+      if(!error_found(result, queryName)) {
+        std::cout << "BOSS " << queryName << " output = "
+                  << (VERY_VERBOSE_QUERY_OUTPUT
+                          ? std::move(result)
+                          : utilities::injectDebugInfoToSpans(std::move(result)))
+                  << std::endl;
+      }
+    }
+
+    for(int i = VERBOSE_QUERY_OUTPUT; i < BENCHMARK_NUM_WARMPUP_ITERATIONS; ++i) {
+      auto traceScope = traceEvents.scope("warm-up", "query");
+      auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
+      if(error_found(result, queryName)) {
+        failed = true;
+        break;
+      }
+    }
+
+    clientLatencies.assign(state.threads(), {});
+    clientRawLatencies.assign(state.threads(), {});
+    if(!LATENCY_DUMP_DIRECTORY.empty()) {
+      // so that recording the latencies does not allocate in the timed loop
+      for(auto& rawLatencies : clientRawLatencies) {
+        rawLatencies.reserve(static_cast<size_t>(state.max_iterations));
+      }
+    }
+    peakRSSReset = allocationTracking::resetPeakRSS();
+    memoryBefore = allocationTracking::snapshot();
+    profiler.startSampling(queryName + " - BOSS");
+    perfCounters.start();
+  }
+
+  // the other clients only access their own latencies once all clients entered the timed loop
+  LatencyHistogram* latencies = nullptr;
+  std::vector<uint64_t>* rawLatencies = nullptr;
+  bool dumpRawLatencies = !LATENCY_DUMP_DIRECTORY.empty();
+  // time spent (by this client) building the query, evaluating it and destroying the result
+  std::chrono::steady_clock::duration buildTime{};
+  std::chrono::steady_clock::duration evalTime{};
+  std::chrono::steady_clock::duration teardownTime{};
+  // wall time of this client's timed loop (from its first iteration, i.e. once all clients entered
+  // it), which the QPS is based on whether or not the benchmark's time is the manual one
+  std::chrono::steady_clock::time_point loopStart;
+  // one event per client and run of the timed loop (Google Benchmark runs it repeatedly while it
+  // determines the number of iterations)
+  auto traceScope = traceEvents.scope(runningBenchmarkName, "query");
+  for(auto _ : state) { // NOLINT
+    auto start = std::chrono::steady_clock::now();
+    if(latencies == nullptr) {
+      latencies = &clientLatencies[state.thread_index()];
+      rawLatencies = &clientRawLatencies[state.thread_index()];
+      loopStart = start;
+    }
+    auto built = start;
+    auto evaluated = start;
+    auto tornDown = start;
+    if(!failed) {
+      {
+        auto expression = utilities::shallowCopy(std::get<boss::ComplexExpression>(query));
+        built = std::chrono::steady_clock::now();
+        auto result = eval(std::move(expression));
+        evaluated = std::chrono::steady_clock::now();
+        if(error_found(result, queryName)) {
+          failed = true;
+        }
+        benchmark::DoNotOptimize(result);
+      } // the result is destroyed here
+      tornDown = std::chrono::steady_clock::now();
+    }
+    if(PREPARED_QUERIES) {
+      state.SetIterationTime(std::chrono::duration<double>(evaluated - built).count());
+    }
+    buildTime += built - start;
+    evalTime += evaluated - built;
+    teardownTime += tornDown - evaluated;
+    auto nanoseconds = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            PREPARED_QUERIES ? evaluated - built : tornDown - start)
+            .count());
+    latencies->record(nanoseconds);
+    if(dumpRawLatencies) {
+      rawLatencies->push_back(nanoseconds);
+    }
+  }
+  auto loopSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loopStart);
+  traceScope.argument("iterations", static_cast<int64_t>(state.iterations()));
+  traceScope.end();
+
+  // summed over the clients, per iteration of all clients
+  auto perIterationSeconds = [](auto duration) {
+    return benchmark::Counter(std::chrono::duration<double>(duration).count(),
+                              benchmark::Counter::kAvgIterations);
+  };
+  state.counters["build_s"] = perIterationSeconds(buildTime);
+  state.counters["eval_s"] = perIterationSeconds(evalTime);
+  state.counters["teardown_s"] = perIterationSeconds(teardownTime);
+  if(state.threads() > 1 && state.iterations() > 0) {
+    // summed over the clients (rather than a kIsRate counter, which would divide the iterations
+    // by the summed evaluation times with --prepared-queries)
+    state.counters["QPS"] = static_cast<double>(state.iterations()) / loopSeconds.count();
+  }
+  if(!isFirstClient) {
+    return;
+  }
+  perfCounters.stop();
+  profiler.stopSampling();
+  auto memoryAfter = allocationTracking::snapshot();
+
+  // process-wide, i.e. of all clients (and the engines' threads), per iteration of all clients
+  auto perIteration = [](auto value) {
+    return benchmark::Counter(static_cast<double>(value), benchmark::Counter::kAvgIterations);
+  };
+  if(allocationTracking::enabled) {
+    state.counters["allocations"] =
+        perIteration(memoryAfter.allocations - memoryBefore.allocations);
+    state.counters["bytes_allocated"] = perIteration(memoryAfter.bytes - memoryBefore.bytes);
+  }
+  state.counters["minor_faults"] = perIteration(memoryAfter.minorFaults - memoryBefore.minorFaults);
+  state.counters["major_faults"] = perIteration(memoryAfter.majorFaults - memoryBefore.majorFaults);
+  // the RSS retained by the timed loop and, if the peak could be reset before it, its peak RSS
+  state.counters["rss_delta_bytes"] =
+      static_cast<double>(memoryAfter.rssBytes - memoryBefore.rssBytes);
+  if(peakRSSReset) {
+    state.counters["peak_rss_delta_bytes"] =
+        static_cast<double>(memoryAfter.peakRSSBytes - memoryBefore.rssBytes);
+  }
+
+  // all clients have left the timed loop once thread 0 did
+  LatencyHistogram histogram;
+  for(auto const& clientHistogram : clientLatencies) {
+    histogram.merge(clientHistogram);
+  }
+  for(auto percentile : {50.0, 90.0, 95.0, 99.0, 99.9}) { // NOLINT
+    std::ostringstream name;
+    name << "latency_p" << percentile << "_s";
+    state.counters[name.str()] = static_cast<double>(histogram.percentile(percentile)) / 1e9;
+  }
+  state.counters["latency_max_s"] = static_cast<double>(histogram.max()) / 1e9; // NOLINT
+  lastMeanLatency = histogram.mean() / 1e9;                                      // NOLINT
+  if(dumpRawLatencies) {
+    dumpLatencies(runningBenchmarkName);
+  }
+}
+
+#endif // QUERYBENCHMARK_CPP
@@ -1,4 +1,6 @@
+#include "columnCache.cpp"
 #include "dataGeneration.cpp"
+#include "queryBenchmark.cpp"
 #include "utilities.cpp"
 #include <benchmark/benchmark.h>
 #include <iostream>
@@ -7,13 +9,52 @@ using SpanArguments = boss::DefaultExpressionSystem::ExpressionSpanArguments;
 using ComplexExpression = boss::DefaultExpressionSystem::ComplexExpression;
 using ExpressionArguments = boss::ExpressionArguments;
 
-void initStorageEngine_selectivity_sweep_uniform_dis(int dataSize) {
+// keys of the generated columns in the synthetic data cache (see columnCache)
+template <typename T>
+static std::string uniformDistributionKey(int64_t dataSize, T lowerBound, T upperBound) {
+  return std::string("uniform_") + columnCache::typeName<T>() + "_" + std::to_string(dataSize) +
+         "_" + std::to_string(lowerBound) + "_" + std::to_string(upperBound) + "_seed" +
+         std::to_string(DEFAULT_DATA_GENERATION_SEED);
+}
+
+template <typename T>
+static std::string partiallySortedKey(int64_t dataSize, size_t numRepeats, float percentageRandom) {
+  return std::string("partially_sorted_") + columnCache::typeName<T>() + "_" +
+         std::to_string(dataSize) + "_" + std::to_string(numRepeats) + "_" +
+         std::to_string(percentageRandom) + "_seed" + std::to_string(DEFAULT_DATA_GENERATION_SEED);
+}
+
+// The synthetic data cache directories of the sweeps' data sets, e.g. to prefetch them
+static std::vector<std::string> selectivitySweepDataFiles(int64_t dataSize) {
+  return {std::string(columnCache::SYNTHETIC_DATA_DIRECTORY) + "/" +
+          uniformDistributionKey<int64_t>(dataSize, 1, 10000)};
+}
+
+static std::vector<std::string> randomnessSweepDataFiles(int64_t dataSize) {
+  auto paths = selectivitySweepDataFiles(dataSize); // the payload column
+  // the key columns of all the cached percentages (but not the tables still being written)
+  auto keyPrefix = std::string("partially_sorted_") + columnCache::typeName<int64_t>() + "_" +
+                   std::to_string(dataSize) + "_";
+  std::error_code error;
+  for(auto const& entry :
+      std::filesystem::directory_iterator(columnCache::SYNTHETIC_DATA_DIRECTORY, error)) {
+    auto name = entry.path().filename().string();
+    if(name.rfind(keyPrefix, 0) == 0 && name.find(".tmp.") == std::string::npos) {
+      paths.push_back(entry.path().string());
+    }
+  }
+  return paths;
+}
+
+void initStorageEngine_selectivity_sweep_uniform_dis(int64_t dataSize) {
   static auto dataSet = std::string("selectivity_sweep_uniform_dis");
 
   if(latestDataSet == dataSet && latestDataSize == dataSize) {
     return;
   }
 
+  auto traceScope = traceEvents.scope(__func__, "storage");
+  traceScope.argument("dataSize", dataSize);
   resetStorageEngine();
   latestDataSet = dataSet;
   latestDataSize = dataSize;
@@ -34,11 +75,13 @@ void initStorageEngine_selectivity_sweep_uniform_dis(int dataSize) {
 
   checkForErrors(evalStorage("CreateTable"_("UNIFORM_DIS"_)));
 
-  SpanArguments keySpan, payloadSpan;
-  keySpan.push_back(
-      boss::Span<int64_t>(std::vector(generateUniformDistribution<int64_t>(dataSize, 1, 10000))));
-  payloadSpan.push_back(
-      boss::Span<int64_t>(std::vector(generateUniformDistribution<int64_t>(dataSize, 1, 10000))));
+  auto generationScope = traceEvents.scope("generate", "generation");
+  auto keySpan = columnCache::cachedSyntheticColumn(
+      uniformDistributionKey<int64_t>(dataSize, 1, 10000),
+      [dataSize]() { return generateUniformDistribution<int64_t>(dataSize, 1, 10000); });
+  auto payloadSpan = columnCache::cachedSyntheticColumn(
+      uniformDistributionKey<int64_t>(dataSize, 1, 10000),
+      [dataSize]() { return generateUniformDistribution<int64_t>(dataSize, 1, 10000); });
 
   ExpressionArguments keyColumn, payloadColumn, columns;
   keyColumn.emplace_back(ComplexExpression("List"_, {}, {}, std::move(keySpan)));
@@ -46,38 +89,18 @@ void initStorageEngine_selectivity_sweep_uniform_dis(int dataSize) {
 
   columns.emplace_back(ComplexExpression("key"_, {}, std::move(keyColumn), {}));
   columns.emplace_back(ComplexExpression("payload"_, {}, std::move(payloadColumn), {}));
+  generationScope.end();
 
+  auto loadScope = traceEvents.scope("LoadDataTable", "storage");
   checkForErrors(evalStorage(
       "LoadDataTable"_("UNIFORM_DIS"_, ComplexExpression("Data"_, {}, std::move(columns), {}))));
 }
 
-void selectivity_sweep_uniform_dis_Benchmark(benchmark::State& state, int dataSize,
+void selectivity_sweep_uniform_dis_Benchmark(benchmark::State& state, int64_t dataSize,
                                              const std::string& queryName) {
-  initStorageEngine_selectivity_sweep_uniform_dis(dataSize);
-
-  auto eval = [](auto&& expression) {
-    boss::expressions::ExpressionSpanArguments spans;
-    spans.emplace_back(boss::expressions::Span<std::string>(librariesToTest));
-    return boss::evaluate("EvaluateInEngines"_(
-        boss::ComplexExpression("List"_, {}, {}, std::move(spans)), std::move(expression)));
-  };
-
-  auto error_found = [](auto&& result, auto const& queryName) {
-    if(!std::holds_alternative<boss::ComplexExpression>(result)) {
-      return false;
-    }
-    if(std::get<boss::ComplexExpression>(result).getHead() == "Table"_) {
-      return false;
-    }
-    if(std::get<boss::ComplexExpression>(result).getHead() == "List"_) {
-      return false;
-    }
-    std::cout << queryName << " Error: "
-              << (VERY_VERBOSE_QUERY_OUTPUT ? std::move(result)
-                                            : utilities::injectDebugInfoToSpans(std::move(result)))
-              << std::endl;
-    return true;
-  };
+  if(state.thread_index() == 0 && !DISPATCH_FLOOR) {
+    initStorageEngine_selectivity_sweep_uniform_dis(dataSize);
+  }
 
   int threshold = state.range(0);
 
@@ -85,46 +108,29 @@ void selectivity_sweep_uniform_dis_Benchmark(benchmark::State& state, int dataSi
       "Select"_("Project"_("UNIFORM_DIS"_, "As"_("key"_, "key"_, "payload"_, "payload"_)),
                 "Where"_("Greater"_(threshold, "key"_)));
 
-  if(VERBOSE_QUERY_OUTPUT) {
-    auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-    if(!error_found(result, queryName)) {
-      std::cout << "BOSS " << queryName << " output = "
-                << (VERY_VERBOSE_QUERY_OUTPUT
-                        ? std::move(result)
-                        : utilities::injectDebugInfoToSpans(std::move(result)))
-                << std::endl;
-    }
-  }
-
-  bool failed = false;
-
-  for(int i = VERBOSE_QUERY_OUTPUT; i < BENCHMARK_NUM_WARMPUP_ITERATIONS; ++i) {
-    auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-    if(error_found(result, queryName)) {
-      failed = true;
-      break;
-    }
-  }
-
-  vtune.startSampling(queryName + " - BOSS");
-  for(auto _ : state) { // NOLINT
-    if(!failed) {
-      auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-      if(error_found(result, queryName)) {
-        failed = true;
-      }
-      benchmark::DoNotOptimize(result);
-    }
-  }
-  vtune.stopSampling();
+  runQueryBenchmark(state, queryName, query);
+  utilities::reportPerfCounters(state, dataSize);
+  // the queries refer to the key and payload columns, both int64 (counted in full)
+  utilities::reportThroughput(state, dataSize,
+                              dataSize * 2 * static_cast<int64_t>(sizeof(int64_t)));
 }
 
-void initStorageEngine_randomness_sweep_sorted_diss(int dataSize, float percentageRandom) {
+void initStorageEngine_randomness_sweep_sorted_diss(int64_t dataSize, float percentageRandom) {
   static auto dataSet = std::string("randomness_sweep_sorted_dis");
+  static float latestPercentageRandom = -1;
+
+  if(latestDataSet == dataSet && latestDataSize == dataSize &&
+     latestPercentageRandom == percentageRandom) {
+    return;
+  }
 
+  auto traceScope = traceEvents.scope(__func__, "storage");
+  traceScope.argument("dataSize", dataSize);
+  traceScope.argument("percentageRandom", std::to_string(percentageRandom));
   resetStorageEngine();
   latestDataSet = dataSet;
   latestDataSize = dataSize;
+  latestPercentageRandom = percentageRandom;
 
   auto evalStorage = [](boss::Expression&& expression) mutable {
     return boss::evaluate("EvaluateInEngines"_("List"_(librariesToTest[0]), std::move(expression)));
@@ -142,11 +148,14 @@ void initStorageEngine_randomness_sweep_sorted_diss(int dataSize, float percenta
 
   checkForErrors(evalStorage("CreateTable"_("PARTIALLY_SORTED_DIS"_)));
 
-  SpanArguments keySpan, payloadSpan;
-  keySpan.push_back(
-      boss::Span<int64_t>(std::vector(generatePartiallySortedOneToOneHundred<int64_t>(dataSize, 10, percentageRandom))));
-  payloadSpan.push_back(
-      boss::Span<int64_t>(std::vector(generateUniformDistribution<int64_t>(dataSize, 1, 10000))));
+  auto generationScope = traceEvents.scope("generate", "generation");
+  auto keySpan = columnCache::cachedSyntheticColumn(
+      partiallySortedKey<int64_t>(dataSize, 10, percentageRandom), [&]() {
+        return generatePartiallySortedOneToOneHundred<int64_t>(dataSize, 10, percentageRandom);
+      });
+  auto payloadSpan = columnCache::cachedSyntheticColumn(
+      uniformDistributionKey<int64_t>(dataSize, 1, 10000),
+      [dataSize]() { return generateUniformDistribution<int64_t>(dataSize, 1, 10000); });
 
   ExpressionArguments keyColumn, payloadColumn, columns;
   keyColumn.emplace_back(ComplexExpression("List"_, {}, {}, std::move(keySpan)));
@@ -154,74 +163,27 @@ void initStorageEngine_randomness_sweep_sorted_diss(int dataSize, float percenta
 
   columns.emplace_back(ComplexExpression("key"_, {}, std::move(keyColumn), {}));
   columns.emplace_back(ComplexExpression("payload"_, {}, std::move(payloadColumn), {}));
+  generationScope.end();
 
+  auto loadScope = traceEvents.scope("LoadDataTable", "storage");
   checkForErrors(evalStorage(
       "LoadDataTable"_("PARTIALLY_SORTED_DIS"_, ComplexExpression("Data"_, {}, std::move(columns), {}))));
 }
 
-void randomness_sweep_sorted_dis_Benchmark(benchmark::State& state, int dataSize,
-                                             const std::string& queryName) {
+void randomness_sweep_sorted_dis_Benchmark(benchmark::State& state, int64_t dataSize,
+                                           const std::string& queryName) {
   float percentageRandom = static_cast<float>(state.range(0)) / 100.0;
-  initStorageEngine_randomness_sweep_sorted_diss(dataSize, percentageRandom);
-
-  auto eval = [](auto&& expression) {
-    boss::expressions::ExpressionSpanArguments spans;
-    spans.emplace_back(boss::expressions::Span<std::string>(librariesToTest));
-    return boss::evaluate("EvaluateInEngines"_(
-        boss::ComplexExpression("List"_, {}, {}, std::move(spans)), std::move(expression)));
-  };
-
-  auto error_found = [](auto&& result, auto const& queryName) {
-    if(!std::holds_alternative<boss::ComplexExpression>(result)) {
-      return false;
-    }
-    if(std::get<boss::ComplexExpression>(result).getHead() == "Table"_) {
-      return false;
-    }
-    if(std::get<boss::ComplexExpression>(result).getHead() == "List"_) {
-      return false;
-    }
-    std::cout << queryName << " Error: "
-              << (VERY_VERBOSE_QUERY_OUTPUT ? std::move(result)
-                                            : utilities::injectDebugInfoToSpans(std::move(result)))
-              << std::endl;
-    return true;
-  };
+  if(state.thread_index() == 0 && !DISPATCH_FLOOR) {
+    initStorageEngine_randomness_sweep_sorted_diss(dataSize, percentageRandom);
+  }
 
   boss::Expression query =
       "Select"_("Project"_("PARTIALLY_SORTED_DIS"_, "As"_("key"_, "key"_, "payload"_, "payload"_)),
                 "Where"_("Greater"_(51, "key"_)));
 
-  if(VERBOSE_QUERY_OUTPUT) {
-    auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-    if(!error_found(result, queryName)) {
-      std::cout << "BOSS " << queryName << " output = "
-                << (VERY_VERBOSE_QUERY_OUTPUT
-                        ? std::move(result)
-                        : utilities::injectDebugInfoToSpans(std::move(result)))
-                << std::endl;
-    }
-  }
-
-  bool failed = false;
-
-  for(int i = VERBOSE_QUERY_OUTPUT; i < BENCHMARK_NUM_WARMPUP_ITERATIONS; ++i) {
-    auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-    if(error_found(result, queryName)) {
-      failed = true;
-      break;
-    }
-  }
-
-  vtune.startSampling(queryName + " - BOSS");
-  for(auto _ : state) { // NOLINT
-    if(!failed) {
-      auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-      if(error_found(result, queryName)) {
-        failed = true;
-      }
-      benchmark::DoNotOptimize(result);
-    }
-  }
-  vtune.stopSampling();
+  runQueryBenchmark(state, queryName, query);
+  utilities::reportPerfCounters(state, dataSize);
+  // the queries refer to the key and payload columns, both int64 (counted in full)
+  utilities::reportThroughput(state, dataSize,
+                              dataSize * 2 * static_cast<int64_t>(sizeof(int64_t)));
 }
\ No newline at end of file
@@ -1,22 +1,237 @@
+#include "columnCache.cpp"
 #include "dataGeneration.cpp"
+#include "queryBenchmark.cpp"
+#include "tpchGeneration.cpp"
 #include "utilities.cpp"
 #include <benchmark/benchmark.h>
+#include <future>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
 
 using SpanArguments = boss::DefaultExpressionSystem::ExpressionSpanArguments;
 using SpanArgument = boss::DefaultExpressionSystem::ExpressionSpanArgument;
 using ComplexExpression = boss::DefaultExpressionSystem::ComplexExpression;
 using ExpressionArguments = boss::ExpressionArguments;
 
-enum TPCH_QUERIES { TPCH_Q1 = 1, TPCH_Q3 = 3, TPCH_Q6 = 6, TPCH_Q9 = 9, TPCH_Q18 = 18 };
+enum TPCH_QUERIES {
+  TPCH_Q1 = 1,
+  TPCH_Q2 = 2,
+  TPCH_Q3 = 3,
+  TPCH_Q4 = 4,
+  TPCH_Q5 = 5,
+  TPCH_Q6 = 6,
+  TPCH_Q7 = 7,
+  TPCH_Q8 = 8,
+  TPCH_Q9 = 9,
+  TPCH_Q10 = 10,
+  TPCH_Q11 = 11,
+  TPCH_Q12 = 12,
+  TPCH_Q13 = 13,
+  TPCH_Q14 = 14,
+  TPCH_Q15 = 15,
+  TPCH_Q16 = 16,
+  TPCH_Q17 = 17,
+  TPCH_Q18 = 18,
+  TPCH_Q19 = 19,
+  TPCH_Q20 = 20,
+  TPCH_Q21 = 21,
+  TPCH_Q22 = 22
+};
 
-void initStorageEngine_TPCH(int dataSize) {
-  static auto dataSet = std::string("TPCH");
+// Tables are prepared (read from the column cache, parsed or generated) concurrently, but the
+// storage engine is only ever called from one thread at a time
+static std::mutex storageEngineMutex;
+
+// Rows of the loaded tables and bytes of their columns (column names are unique across the TPC-H
+// tables), to report the tuples and column bytes that each query refers to
+static std::mutex tpchStatisticsMutex;
+static std::map<std::string, int64_t> tpchTableRows;
+static std::map<std::string, int64_t> tpchColumnBytes;
+
+static int64_t spanSize(SpanArgument const& span) {
+  return std::visit([](auto const& typedSpan) { return static_cast<int64_t>(typedSpan.size()); },
+                    span);
+}
+
+// Records the statistics of a table from its columns, i.e. name("List"_(spans...)) expressions
+static void recordTableStatistics(boss::Symbol const& table, ExpressionArguments const& columns) {
+  std::lock_guard const lock(tpchStatisticsMutex);
+  int64_t rows = 0;
+  for(auto const& column : columns) {
+    auto const* columnExpression = std::get_if<ComplexExpression>(&column);
+    if(columnExpression == nullptr || columnExpression->getDynamicArguments().empty()) {
+      continue;
+    }
+    auto const* list = std::get_if<ComplexExpression>(&columnExpression->getDynamicArguments()[0]);
+    if(list == nullptr) {
+      continue;
+    }
+    int64_t bytes = 0;
+    rows = 0;
+    for(auto const& span : list->getSpanArguments()) {
+      bytes += utilities::spanBytes(span);
+      rows += spanSize(span);
+    }
+    tpchColumnBytes[columnExpression->getHead().getName()] = bytes;
+  }
+  tpchTableRows[table.getName()] = rows;
+}
+
+static void collectSymbols(boss::Expression const& expression, std::set<std::string>& symbols) {
+  if(auto const* symbol = std::get_if<boss::Symbol>(&expression)) {
+    symbols.insert(symbol->getName());
+  } else if(auto const* complexExpression = std::get_if<ComplexExpression>(&expression)) {
+    for(auto const& argument : complexExpression->getDynamicArguments()) {
+      collectSymbols(argument, symbols);
+    }
+  }
+}
+
+// Tuples of the tables and bytes of the columns that a query refers to
+static std::pair<int64_t, int64_t> tpchScannedTuplesAndBytes(boss::Expression const& query) {
+  std::set<std::string> symbols;
+  collectSymbols(query, symbols);
+  std::lock_guard const lock(tpchStatisticsMutex);
+  int64_t tuples = 0;
+  int64_t bytes = 0;
+  for(auto const& symbol : symbols) {
+    if(auto it = tpchTableRows.find(symbol); it != tpchTableRows.end()) {
+      tuples += it->second;
+    }
+    if(auto it = tpchColumnBytes.find(symbol); it != tpchColumnBytes.end()) {
+      bytes += it->second;
+    }
+  }
+  return {tuples, bytes};
+}
+
+// Loads a TPC-H table from its binary column cache (../data/tpch_<N>MB/column_cache/<table>/),
+// or loads the .tbl file with the engine's Load and then writes the cache for the next run. With
+// --harness-tbl-parsing, the .tbl file is parsed (in parallel) in the harness instead and only
+// LoadDataTable holds the storage engine, so concurrent loads overlap their parsing; the columns
+// are then typed by the harness (see tpchGeneration::tableSchema) rather than by the engine.
+// A cache written for another engine library or date encoding is replaced by a newly published
+// directory (see columnCache::writeTable), so engines still using its mapped columns are safe.
+void loadTPCHTable(int dataSize, std::string const& filename, boss::Symbol const& table,
+                   tpchGeneration::DateEncoding const& dateEncoding) {
+  auto checkForErrors = [](auto&& output) {
+    auto* maybeComplexExpr = std::get_if<boss::ComplexExpression>(&output);
+    if(maybeComplexExpr == nullptr) {
+      return;
+    }
+    if(maybeComplexExpr->getHead() == "ErrorWhenEvaluatingExpression"_) {
+      std::cout << "Error: " << output << std::endl;
+    }
+  };
+
+  auto loadDataTable = [&table, &checkForErrors](boss::ExpressionArguments&& columns) {
+    std::lock_guard const lock(storageEngineMutex);
+    auto loadScope = traceEvents.scope("LoadDataTable", "storage");
+    checkForErrors(boss::evaluate("EvaluateInEngines"_(
+        "List"_(librariesToTest[0]),
+        "LoadDataTable"_(table, ComplexExpression("Data"_, {}, std::move(columns), {})))));
+  };
+
+  std::string directory = "../data/tpch_" + std::to_string(dataSize) + "MB/";
+  std::string path = directory + filename + ".tbl";
+  std::string cacheDirectory = directory + "column_cache/" + filename;
+  auto sourceTag = columnCache::tableSourceTag(
+      path, librariesToTest[0],
+      dateEncoding.tag() + (HARNESS_TBL_PARSING ? "|parsed=harness" : "|parsed=engine"));
+  auto traceScope = traceEvents.scope(__func__, "storage");
+  traceScope.argument("table", filename);
+
+  if(!DISABLE_COLUMN_CACHE) {
+    auto cacheReadScope = traceEvents.scope("read column cache", "storage");
+    auto columns = columnCache::readTable(cacheDirectory, sourceTag);
+    cacheReadScope.end();
+    if(columns) {
+      recordTableStatistics(table, *columns);
+      loadDataTable(std::move(*columns));
+      return;
+    }
+  }
+
+  if(!HARNESS_TBL_PARSING) {
+    auto evalStorage = [](boss::Expression&& expression) {
+      std::lock_guard const lock(storageEngineMutex);
+      return boss::evaluate(
+          "EvaluateInEngines"_("List"_(librariesToTest[0]), std::move(expression)));
+    };
+    auto loadScope = traceEvents.scope("Load", "storage");
+    checkForErrors(evalStorage("Load"_(table, path)));
+    loadScope.end();
+
+    auto loadedTable = evalStorage(boss::Symbol(table));
+    if(auto const* tableExpression = std::get_if<ComplexExpression>(&loadedTable)) {
+      recordTableStatistics(table, tableExpression->getDynamicArguments());
+    }
+    auto cacheWriteScope = traceEvents.scope("write column cache", "storage");
+    if(!DISABLE_COLUMN_CACHE && !columnCache::writeTable(cacheDirectory, loadedTable, sourceTag)) {
+      std::cerr << "Warning: unable to write the column cache for " << path << std::endl;
+    }
+    return;
+  }
+
+  auto parseScope = traceEvents.scope("parse", "storage");
+  auto columns = tpchGeneration::parseTable(filename, path, dateEncoding);
+  parseScope.end();
+  if(!columns) {
+    std::cout << "Error: unable to read " << path << std::endl;
+    return;
+  }
+  recordTableStatistics(table, *columns);
+
+  if(!DISABLE_COLUMN_CACHE) {
+    auto cacheWriteScope = traceEvents.scope("write column cache", "storage");
+    boss::Expression parsedTable = ComplexExpression("Table"_, {}, std::move(*columns), {});
+    if(!columnCache::writeTable(cacheDirectory, parsedTable, sourceTag)) {
+      std::cerr << "Warning: unable to write the column cache for " << path << std::endl;
+    }
+    auto [head, unused_, dynamics, spans] =
+        std::get<ComplexExpression>(std::move(parsedTable)).decompose();
+    columns = std::move(dynamics);
+  }
+  loadDataTable(std::move(*columns));
+}
+
+// The files that loadTPCHTable reads for the given tables (the column cache if it was written,
+// otherwise the .tbl files), e.g. to prefetch them
+static std::vector<std::string> tpchDataFiles(int dataSize,
+                                              std::vector<std::string> const& filenames) {
+  std::string directory = "../data/tpch_" + std::to_string(dataSize) + "MB/";
+  std::vector<std::string> paths;
+  for(auto const& filename : filenames) {
+    auto cacheDirectory = directory + "column_cache/" + filename;
+    if(!DISABLE_COLUMN_CACHE && std::filesystem::exists(cacheDirectory + "/manifest")) {
+      paths.push_back(cacheDirectory);
+    } else {
+      paths.push_back(directory + filename + ".tbl");
+    }
+  }
+  return paths;
+}
+
+static std::vector<std::string> tpchDataFiles(int dataSize) {
+  return tpchDataFiles(dataSize, {"lineitem", "orders", "partsupp", "part", "customer",
+                                  "supplier", "nation", "region"});
+}
+
+// Loads all eight TPC-H tables (concurrently, unless --disable-parallel-load) from
+// ../data/tpch_<N>MB/ or, with generateInProcess, generates them in the harness at scale factor
+// N / 1000
+void initStorageEngine_TPCH(int dataSize, bool generateInProcess) {
+  auto dataSet = std::string(generateInProcess ? "TPCH_GENERATED" : "TPCH");
 
   if(latestDataSet == dataSet && latestDataSize == dataSize) {
     return;
   }
 
+  auto traceScope = traceEvents.scope(__func__, "storage");
+  traceScope.argument("dataSet", dataSet);
+  traceScope.argument("dataSize", dataSize);
   resetStorageEngine();
   latestDataSet = dataSet;
   latestDataSize = dataSize;
@@ -46,44 +261,73 @@ void initStorageEngine_TPCH(int dataSize) {
       "l_extendedprice"_, "l_discount"_, "l_tax"_, "l_returnflag"_, "l_linestatus"_, "l_shipdate"_,
       "l_commitdate"_, "l_receiptdate"_, "l_shipinstruct"_, "l_shipmode"_, "l_comment"_)));
 
-#if FALSE
   checkForErrors(evalStorage("CreateTable"_("REGION"_, "r_regionkey"_, "r_name"_, "r_comment"_)));
 
   checkForErrors(evalStorage(
       "CreateTable"_("NATION"_, "n_nationkey"_, "n_name"_, "n_regionkey"_, "n_comment"_)));
 
-  checkForErrors(
-      evalStorage("CreateTable"_("PART"_, "p_partkey"_, "p_name"_, "p_mfgr"_, "p_brand"_, "p_type"_,
-                                 "p_size"_, "p_container"_, "p_retailprice"_, "p_comment"_)));
+  checkForErrors(evalStorage("CreateTable"_("PART"_, "p_partkey"_, "p_name"_, "p_mfgr"_,
+                                            "p_brand"_, "p_type"_, "p_size"_, "p_container"_,
+                                            "p_retailprice"_, "p_comment"_)));
 
-  checkForErrors(
-      evalStorage("CreateTable"_("SUPPLIER"_, "s_suppkey"_, "s_name"_, "s_address"_, "s_nationkey"_,
-                                 "s_phone"_, "s_acctbal"_, "s_comment"_)));
+  checkForErrors(evalStorage("CreateTable"_("SUPPLIER"_, "s_suppkey"_, "s_name"_, "s_address"_,
+                                            "s_nationkey"_, "s_phone"_, "s_acctbal"_,
+                                            "s_comment"_)));
 
   checkForErrors(evalStorage("CreateTable"_("PARTSUPP"_, "ps_partkey"_, "ps_suppkey"_,
                                             "ps_availqty"_, "ps_supplycost"_, "ps_comment"_)));
 
-  checkForErrors(
-      evalStorage("CreateTable"_("CUSTOMER"_, "c_custkey"_, "c_name"_, "c_address"_, "c_nationkey"_,
-                                 "c_phone"_, "c_acctbal"_, "c_mktsegment"_, "c_comment"_)));
+  checkForErrors(evalStorage("CreateTable"_("CUSTOMER"_, "c_custkey"_, "c_name"_, "c_address"_,
+                                            "c_nationkey"_, "c_phone"_, "c_acctbal"_,
+                                            "c_mktsegment"_, "c_comment"_)));
 
   checkForErrors(evalStorage("CreateTable"_(
       "ORDERS"_, "o_orderkey"_, "o_custkey"_, "o_orderstatus"_, "o_totalprice"_, "o_orderdate"_,
       "o_orderpriority"_, "o_clerk"_, "o_shippriority"_, "o_comment"_)));
-#endif
 
+  // largest tables first, so that they start loading (in partitions) as early as possible
   auto filenamesAndTables = std::vector<std::pair<std::string, boss::Symbol>>{
-      {"lineitem", "LINEITEM"_} /*, {"region", "REGION"_},     {"nation", "NATION"_},
-       {"part", "PART"_},         {"supplier", "SUPPLIER"_}, {"partsupp", "PARTSUPP"_},
-       {"customer", "CUSTOMER"_}, {"orders", "ORDERS"_}*/
-  };
+      {"lineitem", "LINEITEM"_}, {"orders", "ORDERS"_},     {"partsupp", "PARTSUPP"_},
+      {"part", "PART"_},         {"customer", "CUSTOMER"_}, {"supplier", "SUPPLIER"_},
+      {"nation", "NATION"_},     {"region", "REGION"_}};
 
-  for(auto const& [filename, table] : filenamesAndTables) {
-    std::string path = "../data/tpch_" + std::to_string(dataSize) + "MB/" + filename + ".tbl";
-    checkForErrors(evalStorage("Load"_(table, path)));
+  auto dateEncoding = tpchGeneration::discoverDateEncoding(evalStorage);
+  std::function<void(std::string const&, boss::Symbol const&)> loadTable =
+      [dataSize, dateEncoding](std::string const& filename, boss::Symbol const& table) {
+        loadTPCHTable(dataSize, filename, table, dateEncoding);
+      };
+  if(generateInProcess) {
+    auto scaleFactor = static_cast<double>(dataSize) / 1000; // NOLINT
+    loadTable = [dateEncoding, scaleFactor, &evalStorage,
+                 &checkForErrors](std::string const& filename, boss::Symbol const& table) {
+      auto generationScope = traceEvents.scope("generate", "generation");
+      generationScope.argument("table", filename);
+      auto columns = tpchGeneration::generateTable(filename, scaleFactor, dateEncoding);
+      recordTableStatistics(table, columns);
+      generationScope.end();
+      std::lock_guard const lock(storageEngineMutex);
+      auto loadScope = traceEvents.scope("LoadDataTable", "storage");
+      checkForErrors(evalStorage("LoadDataTable"_(
+          table, ComplexExpression("Data"_, {}, std::move(columns), {}))));
+    };
+  }
+
+  if(DISABLE_PARALLEL_LOAD) {
+    for(auto const& [filename, table] : filenamesAndTables) {
+      loadTable(filename, table);
+    }
+  } else {
+    std::vector<std::future<void>> loads;
+    for(auto const& [filename, table] : filenamesAndTables) {
+      loads.push_back(std::async(std::launch::async, loadTable, filename, table));
+    }
+    for(auto& load : loads) {
+      load.get();
+    }
   }
 
   if(ENABLE_CONSTRAINTS) {
+    auto constraintsScope = traceEvents.scope("AddConstraint", "storage");
     // primary key constraints
     checkForErrors(evalStorage("AddConstraint"_("PART"_, "PrimaryKey"_("p_partkey"_))));
     checkForErrors(evalStorage("AddConstraint"_("SUPPLIER"_, "PrimaryKey"_("s_suppkey"_))));
@@ -119,19 +363,73 @@ void initStorageEngine_TPCH(int dataSize) {
 static auto& tpchQueryNames() {
   static std::map<int, std::string> names;
   if(names.empty()) {
-    names.try_emplace(static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q1), "TPC-H_Q1");
-    names.try_emplace(static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q3), "TPC-H_Q3");
-    names.try_emplace(static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q6), "TPC-H_Q6");
-    names.try_emplace(static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q9), "TPC-H_Q9");
-    names.try_emplace(static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q18), "TPC-H_Q18");
+    for(int query = TPCH_Q1; query <= TPCH_Q22; ++query) {
+      names.try_emplace(static_cast<int>(DATASETS::TPCH) + query,
+                        "TPC-H_Q" + std::to_string(query));
+    }
+    // p_name LIKE 'forest%' is evaluated as a substring (rather than a prefix) match
+    names[static_cast<int>(DATASETS::TPCH) + TPCH_Q20] = "TPC-H_Q20_variant_contains";
   }
   return names;
 }
 
-auto& tpchQueries() {
+// The queries for the given data size (which Q11's FRACTION depends on)
+auto& tpchQueries(int dataSize) {
   // Queries are Expressions and therefore cannot be just a table i.e. a Symbol
-  static std::map<int, boss::Expression> queries;
+  static std::map<int, std::map<int, boss::Expression>> queriesByDataSize;
+  static std::mutex queriesMutex; // built by the first of the concurrent clients (see --clients)
+  std::lock_guard const lock(queriesMutex);
+  auto& queries = queriesByDataSize[dataSize];
   if(queries.empty()) {
+    auto scaleFactor = static_cast<double>(dataSize) / 1000; // NOLINT
+    // Correlated subqueries are decorrelated into joins with grouped relations, anti-joins into
+    // joins with negated predicates and uncorrelated scalar subqueries are nested in place (as a
+    // Group without By, which yields a single value). LIKE predicates use StringContainsQ.
+
+    // n_nationkey and n_name of the nations in a region
+    auto nationsOfRegion = [](char const* region) {
+      return "Project"_(
+          "Join"_("Select"_("Project"_("REGION"_,
+                                       "As"_("r_regionkey"_, "r_regionkey"_, "r_name"_, "r_name"_)),
+                            "Where"_("StringContainsQ"_("r_name"_, region))),
+                  "Project"_("NATION"_, "As"_("n_nationkey"_, "n_nationkey"_, "n_name"_, "n_name"_,
+                                              "n_regionkey"_, "n_regionkey"_)),
+                  "Where"_("Equal"_("r_regionkey"_, "n_regionkey"_))),
+          "As"_("n_nationkey"_, "n_nationkey"_, "n_name"_, "n_name"_));
+    };
+
+    // n_nationkey of a nation
+    auto nation = [](char const* name) {
+      return "Project"_(
+          "Select"_(
+              "Project"_("NATION"_, "As"_("n_nationkey"_, "n_nationkey"_, "n_name"_, "n_name"_)),
+              "Where"_("StringContainsQ"_("n_name"_, name))),
+          "As"_("n_nationkey"_, "n_nationkey"_));
+    };
+
+    // PARTSUPP with the details of its suppliers in a region
+    auto partSuppliersOfRegion = [&nationsOfRegion](char const* region) {
+      return "Project"_(
+          "Join"_(
+              "Project"_(
+                  "Join"_(nationsOfRegion(region),
+                          "Project"_("SUPPLIER"_,
+                                     "As"_("s_suppkey"_, "s_suppkey"_, "s_name"_, "s_name"_,
+                                           "s_address"_, "s_address"_, "s_nationkey"_,
+                                           "s_nationkey"_, "s_phone"_, "s_phone"_, "s_acctbal"_,
+                                           "s_acctbal"_, "s_comment"_, "s_comment"_)),
+                          "Where"_("Equal"_("n_nationkey"_, "s_nationkey"_))),
+                  "As"_("n_name"_, "n_name"_, "s_suppkey"_, "s_suppkey"_, "s_name"_, "s_name"_,
+                        "s_address"_, "s_address"_, "s_phone"_, "s_phone"_, "s_acctbal"_,
+                        "s_acctbal"_, "s_comment"_, "s_comment"_)),
+              "Project"_("PARTSUPP"_, "As"_("ps_partkey"_, "ps_partkey"_, "ps_suppkey"_,
+                                            "ps_suppkey"_, "ps_supplycost"_, "ps_supplycost"_)),
+              "Where"_("Equal"_("s_suppkey"_, "ps_suppkey"_))),
+          "As"_("n_name"_, "n_name"_, "s_name"_, "s_name"_, "s_address"_, "s_address"_, "s_phone"_,
+                "s_phone"_, "s_acctbal"_, "s_acctbal"_, "s_comment"_, "s_comment"_, "ps_partkey"_,
+                "ps_partkey"_, "ps_supplycost"_, "ps_supplycost"_));
+    };
+
     queries.try_emplace(
         static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q1),
         "Order"_(
@@ -167,6 +465,43 @@ auto& tpchQueries() {
                       "count_order"_, "Count"_("*"_))),
             "By"_("l_returnflag"_, "l_linestatus"_)));
 
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q2),
+        "Top"_(
+            "Project"_(
+                "Join"_(
+                    // minimum supply cost of each part in the region
+                    "Project"_(
+                        "Group"_("Project"_(partSuppliersOfRegion("EUROPE"),
+                                            "As"_("ps_partkey"_, "ps_partkey"_, "ps_supplycost"_,
+                                                  "ps_supplycost"_)),
+                                 "By"_("ps_partkey"_),
+                                 "As"_("min_supplycost"_, "Min"_("ps_supplycost"_))),
+                        "As"_("min_partkey"_, "ps_partkey"_, "min_supplycost"_,
+                              "min_supplycost"_)),
+                    "Project"_(
+                        "Join"_(
+                            "Project"_(
+                                "Select"_("Project"_("PART"_,
+                                                     "As"_("p_partkey"_, "p_partkey"_, "p_mfgr"_,
+                                                           "p_mfgr"_, "p_size"_, "p_size"_,
+                                                           "p_type"_, "p_type"_)),
+                                          "Where"_("And"_("Equal"_("p_size"_, 15), // NOLINT
+                                                          "StringContainsQ"_("p_type"_, "BRASS")))),
+                                "As"_("p_partkey"_, "p_partkey"_, "p_mfgr"_, "p_mfgr"_)),
+                            partSuppliersOfRegion("EUROPE"),
+                            "Where"_("Equal"_("p_partkey"_, "ps_partkey"_))),
+                        "As"_("s_acctbal"_, "s_acctbal"_, "s_name"_, "s_name"_, "n_name"_,
+                              "n_name"_, "p_partkey"_, "p_partkey"_, "p_mfgr"_, "p_mfgr"_,
+                              "s_address"_, "s_address"_, "s_phone"_, "s_phone"_, "s_comment"_,
+                              "s_comment"_, "ps_supplycost"_, "ps_supplycost"_)),
+                    "Where"_("Equal"_("List"_("min_partkey"_, "min_supplycost"_),
+                                      "List"_("p_partkey"_, "ps_supplycost"_)))),
+                "As"_("s_acctbal"_, "s_acctbal"_, "s_name"_, "s_name"_, "n_name"_, "n_name"_,
+                      "p_partkey"_, "p_partkey"_, "p_mfgr"_, "p_mfgr"_, "s_address"_,
+                      "s_address"_, "s_phone"_, "s_phone"_, "s_comment"_, "s_comment"_)),
+            "By"_("s_acctbal"_, "desc"_, "n_name"_, "s_name"_, "p_partkey"_), 100));
+
     queries.try_emplace(
         static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q3),
         "Top"_(
@@ -211,6 +546,87 @@ auto& tpchQueries() {
                 "As"_("revenue"_, "Sum"_("expr1009"_))),
             "By"_("revenue"_, "desc"_, "o_orderdate"_), 10));
 
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q4),
+        "Order"_(
+            "Group"_(
+                "Project"_(
+                    "Join"_(
+                        // EXISTS: the orders with at least one line item received late
+                        "Project"_(
+                            "Group"_("Select"_("Project"_("LINEITEM"_,
+                                                         "As"_("l_orderkey"_, "l_orderkey"_,
+                                                               "l_commitdate"_, "l_commitdate"_,
+                                                               "l_receiptdate"_, "l_receiptdate"_)),
+                                               "Where"_("Greater"_("l_receiptdate"_,
+                                                                   "l_commitdate"_))),
+                                     "By"_("l_orderkey"_), "As"_("late_lines"_, "Count"_("*"_))),
+                            "As"_("l_orderkey"_, "l_orderkey"_)),
+                        "Select"_(
+                            "Project"_("ORDERS"_,
+                                       "As"_("o_orderkey"_, "o_orderkey"_, "o_orderdate"_,
+                                             "o_orderdate"_, "o_orderpriority"_,
+                                             "o_orderpriority"_)),
+                            "Where"_("And"_(
+                                "Greater"_("o_orderdate"_, "DateObject"_("1993-06-30")),
+                                "Greater"_("DateObject"_("1993-10-01"), "o_orderdate"_)))),
+                        "Where"_("Equal"_("l_orderkey"_, "o_orderkey"_))),
+                    "As"_("o_orderpriority"_, "o_orderpriority"_)),
+                "By"_("o_orderpriority"_), "As"_("order_count"_, "Count"_("*"_))),
+            "By"_("o_orderpriority"_)));
+
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q5),
+        "Order"_(
+            "Group"_(
+                "Project"_(
+                    "Join"_(
+                        "Project"_("SUPPLIER"_, "As"_("s_suppkey"_, "s_suppkey"_, "s_nationkey"_,
+                                                      "s_nationkey"_)),
+                        "Project"_(
+                            "Join"_(
+                                "Project"_(
+                                    "Join"_(
+                                        "Project"_(
+                                            "Join"_(nationsOfRegion("ASIA"),
+                                                    "Project"_("CUSTOMER"_,
+                                                               "As"_("c_custkey"_, "c_custkey"_,
+                                                                     "c_nationkey"_,
+                                                                     "c_nationkey"_)),
+                                                    "Where"_("Equal"_("n_nationkey"_,
+                                                                      "c_nationkey"_))),
+                                            "As"_("n_name"_, "n_name"_, "c_custkey"_,
+                                                  "c_custkey"_, "c_nationkey"_, "c_nationkey"_)),
+                                        "Select"_(
+                                            "Project"_("ORDERS"_,
+                                                       "As"_("o_orderkey"_, "o_orderkey"_,
+                                                             "o_custkey"_, "o_custkey"_,
+                                                             "o_orderdate"_, "o_orderdate"_)),
+                                            "Where"_("And"_(
+                                                "Greater"_("o_orderdate"_,
+                                                           "DateObject"_("1993-12-31")),
+                                                "Greater"_("DateObject"_("1995-01-01"),
+                                                           "o_orderdate"_)))),
+                                        "Where"_("Equal"_("c_custkey"_, "o_custkey"_))),
+                                    "As"_("n_name"_, "n_name"_, "c_nationkey"_, "c_nationkey"_,
+                                          "o_orderkey"_, "o_orderkey"_)),
+                                "Project"_("LINEITEM"_,
+                                           "As"_("l_orderkey"_, "l_orderkey"_, "l_suppkey"_,
+                                                 "l_suppkey"_, "l_extendedprice"_,
+                                                 "l_extendedprice"_, "l_discount"_,
+                                                 "l_discount"_)),
+                                "Where"_("Equal"_("o_orderkey"_, "l_orderkey"_))),
+                            "As"_("n_name"_, "n_name"_, "c_nationkey"_, "c_nationkey"_,
+                                  "l_suppkey"_, "l_suppkey"_, "l_extendedprice"_,
+                                  "l_extendedprice"_, "l_discount"_, "l_discount"_)),
+                        // the supplier is in the customer's nation
+                        "Where"_("Equal"_("List"_("s_suppkey"_, "s_nationkey"_),
+                                          "List"_("l_suppkey"_, "c_nationkey"_)))),
+                    "As"_("n_name"_, "n_name"_, "volume"_,
+                          "Times"_("l_extendedprice"_, "Minus"_(1.0, "l_discount"_)))),
+                "By"_("n_name"_), "As"_("revenue"_, "Sum"_("volume"_))),
+            "By"_("revenue"_, "desc"_)));
+
     queries.try_emplace(
         static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q6),
         "Group"_(
@@ -226,6 +642,159 @@ auto& tpchQueries() {
                 "As"_("revenue"_, "Times"_("l_extendedprice"_, "l_discount"_))),
             "Sum"_("revenue"_)));
 
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q7),
+        "Order"_(
+            "Group"_(
+                "Project"_(
+                    "Select"_(
+                        "Join"_(
+                            "Project"_(
+                                "Join"_(
+                                    "Project"_(
+                                        "Join"_(
+                                            "Select"_(
+                                                "Project"_("NATION"_,
+                                                           "As"_("cust_nationkey"_, "n_nationkey"_,
+                                                                 "cust_nation"_, "n_name"_)),
+                                                "Where"_("Or"_(
+                                                    "StringContainsQ"_("cust_nation"_, "FRANCE"),
+                                                    "StringContainsQ"_("cust_nation"_,
+                                                                       "GERMANY")))),
+                                            "Project"_("CUSTOMER"_,
+                                                       "As"_("c_custkey"_, "c_custkey"_,
+                                                             "c_nationkey"_, "c_nationkey"_)),
+                                            "Where"_("Equal"_("cust_nationkey"_, "c_nationkey"_))),
+                                        "As"_("cust_nation"_, "cust_nation"_, "c_custkey"_,
+                                              "c_custkey"_)),
+                                    "Project"_("ORDERS"_, "As"_("o_orderkey"_, "o_orderkey"_,
+                                                                "o_custkey"_, "o_custkey"_)),
+                                    "Where"_("Equal"_("c_custkey"_, "o_custkey"_))),
+                                "As"_("cust_nation"_, "cust_nation"_, "o_orderkey"_,
+                                      "o_orderkey"_)),
+                            "Project"_(
+                                "Join"_(
+                                    "Project"_(
+                                        "Join"_(
+                                            "Select"_(
+                                                "Project"_("NATION"_,
+                                                           "As"_("supp_nationkey"_, "n_nationkey"_,
+                                                                 "supp_nation"_, "n_name"_)),
+                                                "Where"_("Or"_(
+                                                    "StringContainsQ"_("supp_nation"_, "FRANCE"),
+                                                    "StringContainsQ"_("supp_nation"_,
+                                                                       "GERMANY")))),
+                                            "Project"_("SUPPLIER"_,
+                                                       "As"_("s_suppkey"_, "s_suppkey"_,
+                                                             "s_nationkey"_, "s_nationkey"_)),
+                                            "Where"_("Equal"_("supp_nationkey"_, "s_nationkey"_))),
+                                        "As"_("supp_nation"_, "supp_nation"_, "s_suppkey"_,
+                                              "s_suppkey"_)),
+                                    "Select"_(
+                                        "Project"_("LINEITEM"_,
+                                                   "As"_("l_orderkey"_, "l_orderkey"_,
+                                                         "l_suppkey"_, "l_suppkey"_,
+                                                         "l_shipdate"_, "l_shipdate"_,
+                                                         "l_extendedprice"_, "l_extendedprice"_,
+                                                         "l_discount"_, "l_discount"_)),
+                                        "Where"_("And"_(
+                                            "Greater"_("l_shipdate"_, "DateObject"_("1994-12-31")),
+                                            "Greater"_("DateObject"_("1997-01-01"),
+                                                       "l_shipdate"_)))),
+                                    "Where"_("Equal"_("s_suppkey"_, "l_suppkey"_))),
+                                "As"_("supp_nation"_, "supp_nation"_, "l_orderkey"_,
+                                      "l_orderkey"_, "l_shipdate"_, "l_shipdate"_,
+                                      "l_extendedprice"_, "l_extendedprice"_, "l_discount"_,
+                                      "l_discount"_)),
+                            "Where"_("Equal"_("o_orderkey"_, "l_orderkey"_))),
+                        "Where"_("Or"_(
+                            "And"_("StringContainsQ"_("supp_nation"_, "FRANCE"),
+                                   "StringContainsQ"_("cust_nation"_, "GERMANY")),
+                            "And"_("StringContainsQ"_("supp_nation"_, "GERMANY"),
+                                   "StringContainsQ"_("cust_nation"_, "FRANCE"))))),
+                    "As"_("supp_nation"_, "supp_nation"_, "cust_nation"_, "cust_nation"_,
+                          "l_year"_, "Year"_("l_shipdate"_), "volume"_,
+                          "Times"_("l_extendedprice"_, "Minus"_(1.0, "l_discount"_)))),
+                "By"_("supp_nation"_, "cust_nation"_, "l_year"_),
+                "As"_("revenue"_, "Sum"_("volume"_))),
+            "By"_("supp_nation"_, "cust_nation"_, "l_year"_)));
+
+    // Q8: year, supplier nation and volume of the parts' line items ordered in the region
+    auto nationVolumes = [&nationsOfRegion]() {
+      return "Project"_(
+          "Join"_(
+              "Project"_(
+                  "Join"_("Project"_("NATION"_,
+                                     "As"_("n_nationkey"_, "n_nationkey"_, "n_name"_, "n_name"_)),
+                          "Project"_("SUPPLIER"_, "As"_("s_suppkey"_, "s_suppkey"_, "s_nationkey"_,
+                                                        "s_nationkey"_)),
+                          "Where"_("Equal"_("n_nationkey"_, "s_nationkey"_))),
+                  "As"_("n_name"_, "n_name"_, "s_suppkey"_, "s_suppkey"_)),
+              "Project"_(
+                  "Join"_(
+                      "Project"_(
+                          "Join"_(
+                              "Project"_(
+                                  "Join"_(nationsOfRegion("AMERICA"),
+                                          "Project"_("CUSTOMER"_,
+                                                     "As"_("c_custkey"_, "c_custkey"_,
+                                                           "c_nationkey"_, "c_nationkey"_)),
+                                          "Where"_("Equal"_("n_nationkey"_, "c_nationkey"_))),
+                                  "As"_("c_custkey"_, "c_custkey"_)),
+                              "Select"_(
+                                  "Project"_("ORDERS"_, "As"_("o_orderkey"_, "o_orderkey"_,
+                                                              "o_custkey"_, "o_custkey"_,
+                                                              "o_orderdate"_, "o_orderdate"_)),
+                                  "Where"_("And"_(
+                                      "Greater"_("o_orderdate"_, "DateObject"_("1994-12-31")),
+                                      "Greater"_("DateObject"_("1997-01-01"), "o_orderdate"_)))),
+                              "Where"_("Equal"_("c_custkey"_, "o_custkey"_))),
+                          "As"_("o_orderkey"_, "o_orderkey"_, "o_orderdate"_, "o_orderdate"_)),
+                      "Project"_(
+                          "Join"_(
+                              "Project"_(
+                                  "Select"_(
+                                      "Project"_("PART"_, "As"_("p_partkey"_, "p_partkey"_,
+                                                                "p_type"_, "p_type"_)),
+                                      "Where"_("StringContainsQ"_("p_type"_,
+                                                                  "ECONOMY ANODIZED STEEL"))),
+                                  "As"_("p_partkey"_, "p_partkey"_)),
+                              "Project"_("LINEITEM"_,
+                                         "As"_("l_orderkey"_, "l_orderkey"_, "l_partkey"_,
+                                               "l_partkey"_, "l_suppkey"_, "l_suppkey"_,
+                                               "l_extendedprice"_, "l_extendedprice"_,
+                                               "l_discount"_, "l_discount"_)),
+                              "Where"_("Equal"_("p_partkey"_, "l_partkey"_))),
+                          "As"_("l_orderkey"_, "l_orderkey"_, "l_suppkey"_, "l_suppkey"_,
+                                "l_extendedprice"_, "l_extendedprice"_, "l_discount"_,
+                                "l_discount"_)),
+                      "Where"_("Equal"_("o_orderkey"_, "l_orderkey"_))),
+                  "As"_("o_orderdate"_, "o_orderdate"_, "l_suppkey"_, "l_suppkey"_,
+                        "l_extendedprice"_, "l_extendedprice"_, "l_discount"_, "l_discount"_)),
+              "Where"_("Equal"_("s_suppkey"_, "l_suppkey"_))),
+          "As"_("o_year"_, "Year"_("o_orderdate"_), "volume"_,
+                "Times"_("l_extendedprice"_, "Minus"_(1.0, "l_discount"_)), "nation"_,
+                "n_name"_));
+    };
+
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q8),
+        "Order"_(
+            "Project"_(
+                "Join"_(
+                    // the CASE expression as a separate aggregation of the nation's volumes
+                    "Project"_(
+                        "Group"_("Select"_(nationVolumes(),
+                                           "Where"_("StringContainsQ"_("nation"_, "BRAZIL"))),
+                                 "By"_("o_year"_), "As"_("nation_volume"_, "Sum"_("volume"_))),
+                        "As"_("nation_year"_, "o_year"_, "nation_volume"_, "nation_volume"_)),
+                    "Group"_(nationVolumes(), "By"_("o_year"_),
+                             "As"_("total_volume"_, "Sum"_("volume"_))),
+                    "Where"_("Equal"_("nation_year"_, "o_year"_))),
+                "As"_("o_year"_, "o_year"_, "mkt_share"_,
+                      "Divide"_("nation_volume"_, "total_volume"_))),
+            "By"_("o_year"_)));
+
     queries.try_emplace(
         static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q9),
         "Order"_(
@@ -242,14 +811,9 @@ auto& tpchQueries() {
                                             "Select"_(
                                                 "Project"_("PART"_,
                                                            "As"_("p_partkey"_, "p_partkey"_,
-                                                                 "p_retailprice"_,
-                                                                 "p_retailprice"_)),
-                                                "Where"_("And"_("Greater"_("p_retailprice"_,
-                                                                           1006.05), // NOLINT
-                                                                "Greater"_(1080.1,   // NOLINT
-                                                                           "p_retailprice"_)))),
-                                            "As"_("p_partkey"_, "p_partkey"_, "p_retailprice"_,
-                                                  "p_retailprice"_)),
+                                                                 "p_name"_, "p_name"_)),
+                                                "Where"_("StringContainsQ"_("p_name"_, "green"))),
+                                            "As"_("p_partkey"_, "p_partkey"_)),
                                         "Project"_(
                                             "Join"_(
                                                 "Project"_(
@@ -298,6 +862,332 @@ auto& tpchQueries() {
                 "By"_("nation"_, "o_year"_), "Sum"_("amount"_)),
             "By"_("nation"_, "o_year"_, "desc"_)));
 
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q10),
+        "Top"_(
+            "Group"_(
+                "Project"_(
+                    "Join"_(
+                        "Project"_(
+                            "Join"_("Project"_("NATION"_, "As"_("n_nationkey"_, "n_nationkey"_,
+                                                                "n_name"_, "n_name"_)),
+                                    "Project"_("CUSTOMER"_,
+                                               "As"_("c_custkey"_, "c_custkey"_, "c_name"_,
+                                                     "c_name"_, "c_address"_, "c_address"_,
+                                                     "c_nationkey"_, "c_nationkey"_, "c_phone"_,
+                                                     "c_phone"_, "c_acctbal"_, "c_acctbal"_,
+                                                     "c_comment"_, "c_comment"_)),
+                                    "Where"_("Equal"_("n_nationkey"_, "c_nationkey"_))),
+                            "As"_("c_custkey"_, "c_custkey"_, "c_name"_, "c_name"_, "c_address"_,
+                                  "c_address"_, "c_phone"_, "c_phone"_, "c_acctbal"_,
+                                  "c_acctbal"_, "c_comment"_, "c_comment"_, "n_name"_,
+                                  "n_name"_)),
+                        "Project"_(
+                            "Join"_(
+                                "Select"_(
+                                    "Project"_("ORDERS"_,
+                                               "As"_("o_orderkey"_, "o_orderkey"_, "o_custkey"_,
+                                                     "o_custkey"_, "o_orderdate"_,
+                                                     "o_orderdate"_)),
+                                    "Where"_("And"_(
+                                        "Greater"_("o_orderdate"_, "DateObject"_("1993-09-30")),
+                                        "Greater"_("DateObject"_("1994-01-01"), "o_orderdate"_)))),
+                                "Select"_(
+                                    "Project"_("LINEITEM"_,
+                                               "As"_("l_orderkey"_, "l_orderkey"_,
+                                                     "l_returnflag"_, "l_returnflag"_,
+                                                     "l_extendedprice"_, "l_extendedprice"_,
+                                                     "l_discount"_, "l_discount"_)),
+                                    "Where"_("StringContainsQ"_("l_returnflag"_, "R"))),
+                                "Where"_("Equal"_("o_orderkey"_, "l_orderkey"_))),
+                            "As"_("o_custkey"_, "o_custkey"_, "l_extendedprice"_,
+                                  "l_extendedprice"_, "l_discount"_, "l_discount"_)),
+                        "Where"_("Equal"_("c_custkey"_, "o_custkey"_))),
+                    "As"_("c_custkey"_, "c_custkey"_, "c_name"_, "c_name"_, "c_acctbal"_,
+                          "c_acctbal"_, "c_phone"_, "c_phone"_, "n_name"_, "n_name"_,
+                          "c_address"_, "c_address"_, "c_comment"_, "c_comment"_, "volume"_,
+                          "Times"_("l_extendedprice"_, "Minus"_(1.0, "l_discount"_)))),
+                "By"_("c_custkey"_, "c_name"_, "c_acctbal"_, "c_phone"_, "n_name"_,
+                      "c_address"_, "c_comment"_),
+                "As"_("revenue"_, "Sum"_("volume"_))),
+            "By"_("revenue"_, "desc"_), 20));
+
+    // Q11: value of the stock of each part at the suppliers of a nation
+    auto nationalStockValues = [&nation]() {
+      return "Project"_(
+          "Join"_(
+              "Project"_(
+                  "Join"_(nation("GERMANY"),
+                          "Project"_("SUPPLIER"_, "As"_("s_suppkey"_, "s_suppkey"_, "s_nationkey"_,
+                                                        "s_nationkey"_)),
+                          "Where"_("Equal"_("n_nationkey"_, "s_nationkey"_))),
+                  "As"_("s_suppkey"_, "s_suppkey"_)),
+              "Project"_("PARTSUPP"_,
+                         "As"_("ps_partkey"_, "ps_partkey"_, "ps_suppkey"_, "ps_suppkey"_,
+                               "ps_availqty"_, "ps_availqty"_, "ps_supplycost"_,
+                               "ps_supplycost"_)),
+              "Where"_("Equal"_("s_suppkey"_, "ps_suppkey"_))),
+          "As"_("ps_partkey"_, "ps_partkey"_, "value"_,
+                "Times"_("ps_supplycost"_, "ps_availqty"_)));
+    };
+
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q11),
+        "Order"_(
+            "Select"_(
+                "Group"_(nationalStockValues(), "By"_("ps_partkey"_),
+                         "As"_("value"_, "Sum"_("value"_))),
+                "Where"_("Greater"_(
+                    "value"_, "Times"_("Group"_(nationalStockValues(), "Sum"_("value"_)),
+                                       0.0001 / scaleFactor)))), // NOLINT: FRACTION
+            "By"_("value"_, "desc"_)));
+
+    // Q12: order priority and ship mode of the line items received late in the year
+    auto lateShipments = []() {
+      return "Project"_(
+          "Join"_(
+              "Project"_("ORDERS"_, "As"_("o_orderkey"_, "o_orderkey"_, "o_orderpriority"_,
+                                          "o_orderpriority"_)),
+              "Select"_(
+                  "Project"_("LINEITEM"_,
+                             "As"_("l_orderkey"_, "l_orderkey"_, "l_shipmode"_, "l_shipmode"_,
+                                   "l_shipdate"_, "l_shipdate"_, "l_commitdate"_,
+                                   "l_commitdate"_, "l_receiptdate"_, "l_receiptdate"_)),
+                  "Where"_("And"_("Or"_("StringContainsQ"_("l_shipmode"_, "MAIL"),
+                                        "StringContainsQ"_("l_shipmode"_, "SHIP")),
+                                  "Greater"_("l_receiptdate"_, "l_commitdate"_),
+                                  "Greater"_("l_commitdate"_, "l_shipdate"_),
+                                  "Greater"_("l_receiptdate"_, "DateObject"_("1993-12-31")),
+                                  "Greater"_("DateObject"_("1995-01-01"), "l_receiptdate"_)))),
+              "Where"_("Equal"_("o_orderkey"_, "l_orderkey"_))),
+          "As"_("l_shipmode"_, "l_shipmode"_, "o_orderpriority"_, "o_orderpriority"_));
+    };
+
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q12),
+        "Order"_(
+            "Project"_(
+                "Join"_(
+                    // the two CASE expressions as separate aggregations
+                    "Project"_(
+                        "Group"_("Select"_(lateShipments(),
+                                           "Where"_("Or"_(
+                                               "StringContainsQ"_("o_orderpriority"_, "1-URGENT"),
+                                               "StringContainsQ"_("o_orderpriority"_, "2-HIGH")))),
+                                 "By"_("l_shipmode"_), "As"_("high_line_count"_, "Count"_("*"_))),
+                        "As"_("high_shipmode"_, "l_shipmode"_, "high_line_count"_,
+                              "high_line_count"_)),
+                    "Group"_("Select"_(lateShipments(),
+                                       "Where"_("Not"_("Or"_(
+                                           "StringContainsQ"_("o_orderpriority"_, "1-URGENT"),
+                                           "StringContainsQ"_("o_orderpriority"_, "2-HIGH"))))),
+                             "By"_("l_shipmode"_), "As"_("low_line_count"_, "Count"_("*"_))),
+                    "Where"_("Equal"_("high_shipmode"_, "l_shipmode"_))),
+                "As"_("l_shipmode"_, "l_shipmode"_, "high_line_count"_, "high_line_count"_,
+                      "low_line_count"_, "low_line_count"_)),
+            "By"_("l_shipmode"_)));
+
+    // Q13: the LEFT OUTER JOIN is an inner join plus the c_count = 0 group, whose custdist is the
+    // count difference of all customers and the customers with matching orders. The distribution
+    // is joined with a two-row copy table (REGION keys 0 and 1): copy 1 keeps the c_count >= 1
+    // groups, copy 0 folds all of them, negated, into the c_count = 0 group. The NOT LIKE
+    // '%special%requests%' filter is approximated as "not containing both words" (in any order).
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q13),
+        "Order"_(
+            "Project"_(
+                "Group"_(
+                    "Project"_(
+                        "Join"_(
+                            "Project"_(
+                                "Group"_(
+                                    "Group"_(
+                                        "Project"_(
+                                            "Join"_(
+                                                "Project"_("CUSTOMER"_,
+                                                           "As"_("c_custkey"_, "c_custkey"_)),
+                                                "Select"_(
+                                                    "Project"_("ORDERS"_,
+                                                               "As"_("o_orderkey"_, "o_orderkey"_,
+                                                                     "o_custkey"_, "o_custkey"_,
+                                                                     "o_comment"_, "o_comment"_)),
+                                                    "Where"_("Not"_("And"_(
+                                                        "StringContainsQ"_("o_comment"_,
+                                                                           "special"),
+                                                        "StringContainsQ"_("o_comment"_,
+                                                                           "requests"))))),
+                                                "Where"_("Equal"_("c_custkey"_, "o_custkey"_))),
+                                            "As"_("c_custkey"_, "c_custkey"_)),
+                                        "By"_("c_custkey"_), "As"_("c_count"_, "Count"_("*"_))),
+                                    "By"_("c_count"_), "As"_("custdist"_, "Count"_("*"_))),
+                                "As"_("c_count"_, "c_count"_, "custdist"_, "custdist"_,
+                                      "distribution_key"_, "Times"_(0, "c_count"_))),
+                            "Select"_("Project"_("REGION"_,
+                                                 "As"_("copy"_, "r_regionkey"_, "copy_key"_,
+                                                       "Times"_(0, "r_regionkey"_))),
+                                      "Where"_("Greater"_(2, "copy"_))),
+                            "Where"_("Equal"_("distribution_key"_, "copy_key"_))),
+                        "As"_("group_count"_, "Times"_("c_count"_, "copy"_), "signed_custdist"_,
+                              "Times"_("custdist"_, "Minus"_("Times"_(2, "copy"_), 1)), "copy"_,
+                              "copy"_)),
+                    "By"_("group_count"_),
+                    "As"_("custdist_sum"_, "Sum"_("signed_custdist"_), "group_copy"_,
+                          "Min"_("copy"_))),
+                "As"_("c_count"_, "group_count"_, "custdist"_,
+                      "Plus"_("custdist_sum"_,
+                              "Times"_("Group"_("Project"_("CUSTOMER"_,
+                                                           "As"_("c_custkey"_, "c_custkey"_)),
+                                                "Count"_("*"_)),
+                                       "Minus"_(1, "group_copy"_))))),
+            "By"_("custdist"_, "desc"_, "c_count"_, "desc"_)));
+
+    // Q14: part type and volume of the line items shipped in the month
+    auto monthlyShipments = []() {
+      return "Project"_(
+          "Join"_(
+              "Project"_("PART"_, "As"_("p_partkey"_, "p_partkey"_, "p_type"_, "p_type"_)),
+              "Select"_(
+                  "Project"_("LINEITEM"_,
+                             "As"_("l_partkey"_, "l_partkey"_, "l_shipdate"_, "l_shipdate"_,
+                                   "l_extendedprice"_, "l_extendedprice"_, "l_discount"_,
+                                   "l_discount"_)),
+                  "Where"_("And"_("Greater"_("l_shipdate"_, "DateObject"_("1995-08-31")),
+                                  "Greater"_("DateObject"_("1995-10-01"), "l_shipdate"_)))),
+              "Where"_("Equal"_("p_partkey"_, "l_partkey"_))),
+          "As"_("p_type"_, "p_type"_, "volume"_,
+                "Times"_("l_extendedprice"_, "Minus"_(1.0, "l_discount"_))));
+    };
+
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q14),
+        "Times"_(100.0, // NOLINT
+                 "Divide"_("Group"_("Select"_(monthlyShipments(),
+                                              "Where"_("StringContainsQ"_("p_type"_, "PROMO"))),
+                                    "Sum"_("volume"_)),
+                           "Group"_(monthlyShipments(), "Sum"_("volume"_)))));
+
+    // Q15: revenue of the suppliers in the quarter (the revenue0 view)
+    auto supplierRevenue = []() {
+      return "Group"_(
+          "Project"_(
+              "Select"_(
+                  "Project"_("LINEITEM"_,
+                             "As"_("l_suppkey"_, "l_suppkey"_, "l_shipdate"_, "l_shipdate"_,
+                                   "l_extendedprice"_, "l_extendedprice"_, "l_discount"_,
+                                   "l_discount"_)),
+                  "Where"_("And"_("Greater"_("l_shipdate"_, "DateObject"_("1995-12-31")),
+                                  "Greater"_("DateObject"_("1996-04-01"), "l_shipdate"_)))),
+              "As"_("supplier_no"_, "l_suppkey"_, "volume"_,
+                    "Times"_("l_extendedprice"_, "Minus"_(1.0, "l_discount"_)))),
+          "By"_("supplier_no"_), "As"_("total_revenue"_, "Sum"_("volume"_)));
+    };
+
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q15),
+        "Order"_(
+            "Project"_(
+                "Join"_(
+                    // the suppliers with the maximum revenue (all of them if there are ties)
+                    "Select"_(supplierRevenue(),
+                              "Where"_("Equal"_("total_revenue"_,
+                                                "Group"_(supplierRevenue(),
+                                                         "Max"_("total_revenue"_))))),
+                    "Project"_("SUPPLIER"_, "As"_("s_suppkey"_, "s_suppkey"_, "s_name"_, "s_name"_,
+                                                  "s_address"_, "s_address"_, "s_phone"_,
+                                                  "s_phone"_)),
+                    "Where"_("Equal"_("supplier_no"_, "s_suppkey"_))),
+                "As"_("s_suppkey"_, "s_suppkey"_, "s_name"_, "s_name"_, "s_address"_,
+                      "s_address"_, "s_phone"_, "s_phone"_, "total_revenue"_, "total_revenue"_)),
+            "By"_("s_suppkey"_)));
+
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q16),
+        "Order"_(
+            "Group"_(
+                // COUNT(DISTINCT ps_suppkey) as a group on the supplier followed by a count
+                "Group"_(
+                    "Project"_(
+                        "Join"_(
+                            "Select"_(
+                                "Project"_("PART"_,
+                                           "As"_("p_partkey"_, "p_partkey"_, "p_brand"_,
+                                                 "p_brand"_, "p_type"_, "p_type"_, "p_size"_,
+                                                 "p_size"_)),
+                                "Where"_("And"_(
+                                    "Not"_("StringContainsQ"_("p_brand"_, "Brand#45")),
+                                    "Not"_("StringContainsQ"_("p_type"_, "MEDIUM POLISHED")),
+                                    "Or"_("Equal"_("p_size"_, 49), "Equal"_("p_size"_, 14),
+                                          "Equal"_("p_size"_, 23), "Equal"_("p_size"_, 45),
+                                          "Equal"_("p_size"_, 19), "Equal"_("p_size"_, 3),
+                                          "Equal"_("p_size"_, 36), "Equal"_("p_size"_, 9))))),
+                            "Project"_(
+                                // NOT IN (suppliers with complaints) as a negated predicate
+                                "Join"_(
+                                    "Select"_(
+                                        "Project"_("SUPPLIER"_, "As"_("s_suppkey"_, "s_suppkey"_,
+                                                                      "s_comment"_,
+                                                                      "s_comment"_)),
+                                        "Where"_("Not"_("And"_(
+                                            "StringContainsQ"_("s_comment"_, "Customer"),
+                                            "StringContainsQ"_("s_comment"_, "Complaints"))))),
+                                    "Project"_("PARTSUPP"_, "As"_("ps_partkey"_, "ps_partkey"_,
+                                                                  "ps_suppkey"_, "ps_suppkey"_)),
+                                    "Where"_("Equal"_("s_suppkey"_, "ps_suppkey"_))),
+                                "As"_("ps_partkey"_, "ps_partkey"_, "ps_suppkey"_,
+                                      "ps_suppkey"_)),
+                            "Where"_("Equal"_("p_partkey"_, "ps_partkey"_))),
+                        "As"_("p_brand"_, "p_brand"_, "p_type"_, "p_type"_, "p_size"_, "p_size"_,
+                              "ps_suppkey"_, "ps_suppkey"_)),
+                    "By"_("p_brand"_, "p_type"_, "p_size"_, "ps_suppkey"_),
+                    "As"_("supplier_parts"_, "Count"_("*"_))),
+                "By"_("p_brand"_, "p_type"_, "p_size"_),
+                "As"_("supplier_cnt"_, "Count"_("*"_))),
+            "By"_("supplier_cnt"_, "desc"_, "p_brand"_, "p_type"_, "p_size"_)));
+
+    // Q17: p_partkey of the parts of a brand and container
+    auto brandContainerParts = []() {
+      return "Project"_(
+          "Select"_("Project"_("PART"_, "As"_("p_partkey"_, "p_partkey"_, "p_brand"_, "p_brand"_,
+                                              "p_container"_, "p_container"_)),
+                    "Where"_("And"_("StringContainsQ"_("p_brand"_, "Brand#23"),
+                                    "StringContainsQ"_("p_container"_, "MED BOX")))),
+          "As"_("p_partkey"_, "p_partkey"_));
+    };
+
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q17),
+        "Project"_(
+            "Group"_(
+                "Select"_(
+                    "Join"_(
+                        // the correlated average quantity of each part
+                        "Project"_(
+                            "Group"_(
+                                "Project"_(
+                                    "Join"_(brandContainerParts(),
+                                            "Project"_("LINEITEM"_,
+                                                       "As"_("l_partkey"_, "l_partkey"_,
+                                                             "l_quantity"_, "l_quantity"_)),
+                                            "Where"_("Equal"_("p_partkey"_, "l_partkey"_))),
+                                    "As"_("l_partkey"_, "l_partkey"_, "l_quantity"_,
+                                          "l_quantity"_)),
+                                "By"_("l_partkey"_), "As"_("avg_quantity"_, "Avg"_("l_quantity"_))),
+                            "As"_("avg_partkey"_, "l_partkey"_, "quantity_threshold"_,
+                                  "Times"_(0.2, "avg_quantity"_))), // NOLINT
+                        "Project"_(
+                            "Join"_(brandContainerParts(),
+                                    "Project"_("LINEITEM"_,
+                                               "As"_("l_partkey"_, "l_partkey"_, "l_quantity"_,
+                                                     "l_quantity"_, "l_extendedprice"_,
+                                                     "l_extendedprice"_)),
+                                    "Where"_("Equal"_("p_partkey"_, "l_partkey"_))),
+                            "As"_("l_partkey"_, "l_partkey"_, "l_quantity"_, "l_quantity"_,
+                                  "l_extendedprice"_, "l_extendedprice"_)),
+                        "Where"_("Equal"_("avg_partkey"_, "l_partkey"_))),
+                    "Where"_("Greater"_("quantity_threshold"_, "l_quantity"_))),
+                "As"_("total_price"_, "Sum"_("l_extendedprice"_))),
+            "As"_("avg_yearly"_, "Divide"_("total_price"_, 7.0)))); // NOLINT
+
     queries.try_emplace(
         static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q18),
         "Top"_(
@@ -332,75 +1222,279 @@ auto& tpchQueries() {
                 "By"_("o_custkey"_, "o_orderkey"_, "o_orderdate"_, "o_totalprice"_),
                 "Sum"_("sum_l_quantity"_)),
             "By"_("o_totalprice"_, "desc"_, "o_orderdate"_), 100));
-  }
-  return queries;
-}
 
-void TPCH_Benchmark(benchmark::State& state, int queryIdx, int dataSize) {
-  initStorageEngine_TPCH(dataSize);
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q19),
+        "Group"_(
+            "Project"_(
+                "Select"_(
+                    "Join"_(
+                        "Project"_("PART"_, "As"_("p_partkey"_, "p_partkey"_, "p_brand"_,
+                                                  "p_brand"_, "p_container"_, "p_container"_,
+                                                  "p_size"_, "p_size"_)),
+                        "Select"_(
+                            "Project"_("LINEITEM"_,
+                                       "As"_("l_partkey"_, "l_partkey"_, "l_quantity"_,
+                                             "l_quantity"_, "l_extendedprice"_,
+                                             "l_extendedprice"_, "l_discount"_, "l_discount"_,
+                                             "l_shipinstruct"_, "l_shipinstruct"_, "l_shipmode"_,
+                                             "l_shipmode"_)),
+                            // l_shipmode IN ('AIR', 'REG AIR')
+                            "Where"_("And"_(
+                                "StringContainsQ"_("l_shipmode"_, "AIR"),
+                                "StringContainsQ"_("l_shipinstruct"_, "DELIVER IN PERSON")))),
+                        "Where"_("Equal"_("p_partkey"_, "l_partkey"_))),
+                    "Where"_("Or"_(
+                        "And"_("StringContainsQ"_("p_brand"_, "Brand#12"),
+                               "Or"_("StringContainsQ"_("p_container"_, "SM CASE"),
+                                     "StringContainsQ"_("p_container"_, "SM BOX"),
+                                     "StringContainsQ"_("p_container"_, "SM PACK"),
+                                     "StringContainsQ"_("p_container"_, "SM PKG")),
+                               "Greater"_("l_quantity"_, 0), "Greater"_(12, "l_quantity"_),
+                               "Greater"_("p_size"_, 0), "Greater"_(6, "p_size"_)), // NOLINT
+                        "And"_("StringContainsQ"_("p_brand"_, "Brand#23"),
+                               "Or"_("StringContainsQ"_("p_container"_, "MED BAG"),
+                                     "StringContainsQ"_("p_container"_, "MED BOX"),
+                                     "StringContainsQ"_("p_container"_, "MED PKG"),
+                                     "StringContainsQ"_("p_container"_, "MED PACK")),
+                               "Greater"_("l_quantity"_, 9), "Greater"_(21, "l_quantity"_),
+                               "Greater"_("p_size"_, 0), "Greater"_(11, "p_size"_)), // NOLINT
+                        "And"_("StringContainsQ"_("p_brand"_, "Brand#34"),
+                               "Or"_("StringContainsQ"_("p_container"_, "LG CASE"),
+                                     "StringContainsQ"_("p_container"_, "LG BOX"),
+                                     "StringContainsQ"_("p_container"_, "LG PACK"),
+                                     "StringContainsQ"_("p_container"_, "LG PKG")),
+                               "Greater"_("l_quantity"_, 19), "Greater"_(31, "l_quantity"_),
+                               "Greater"_("p_size"_, 0), "Greater"_(16, "p_size"_))))), // NOLINT
+                "As"_("revenue"_, "Times"_("l_extendedprice"_, "Minus"_(1.0, "l_discount"_)))),
+            "Sum"_("revenue"_)));
 
-  auto eval = [](auto&& expression) {
-    boss::expressions::ExpressionSpanArguments spans;
-    spans.emplace_back(boss::expressions::Span<std::string>(librariesToTest));
-    return boss::evaluate("EvaluateInEngines"_(
-        boss::ComplexExpression("List"_, {}, {}, std::move(spans)), std::move(expression)));
-  };
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q20),
+        "Order"_(
+            "Project"_(
+                "Join"_(
+                    // IN (suppliers with an excess of a part): the distinct suppliers
+                    "Project"_(
+                        "Group"_(
+                            "Project"_(
+                                "Select"_(
+                                    "Join"_(
+                                        // the correlated quantity shipped by each supplier
+                                        "Project"_(
+                                            "Group"_(
+                                                "Select"_(
+                                                    "Project"_("LINEITEM"_,
+                                                               "As"_("l_partkey"_, "l_partkey"_,
+                                                                     "l_suppkey"_, "l_suppkey"_,
+                                                                     "l_quantity"_, "l_quantity"_,
+                                                                     "l_shipdate"_,
+                                                                     "l_shipdate"_)),
+                                                    "Where"_("And"_(
+                                                        "Greater"_("l_shipdate"_,
+                                                                   "DateObject"_("1993-12-31")),
+                                                        "Greater"_("DateObject"_("1995-01-01"),
+                                                                   "l_shipdate"_)))),
+                                                "By"_("l_partkey"_, "l_suppkey"_),
+                                                "As"_("sum_quantity"_, "Sum"_("l_quantity"_))),
+                                            "As"_("l_partkey"_, "l_partkey"_, "l_suppkey"_,
+                                                  "l_suppkey"_, "quantity_threshold"_,
+                                                  "Times"_(0.5, "sum_quantity"_))), // NOLINT
+                                        "Project"_(
+                                            "Join"_(
+                                                // p_name LIKE 'forest%' as a substring match,
+                                                // hence the variant's name (see tpchQueryNames)
+                                                "Project"_(
+                                                    "Select"_("Project"_("PART"_,
+                                                                         "As"_("p_partkey"_,
+                                                                               "p_partkey"_,
+                                                                               "p_name"_,
+                                                                               "p_name"_)),
+                                                              "Where"_("StringContainsQ"_(
+                                                                  "p_name"_, "forest"))),
+                                                    "As"_("p_partkey"_, "p_partkey"_)),
+                                                "Project"_("PARTSUPP"_,
+                                                           "As"_("ps_partkey"_, "ps_partkey"_,
+                                                                 "ps_suppkey"_, "ps_suppkey"_,
+                                                                 "ps_availqty"_,
+                                                                 "ps_availqty"_)),
+                                                "Where"_("Equal"_("p_partkey"_, "ps_partkey"_))),
+                                            "As"_("ps_partkey"_, "ps_partkey"_, "ps_suppkey"_,
+                                                  "ps_suppkey"_, "ps_availqty"_,
+                                                  "ps_availqty"_)),
+                                        "Where"_("Equal"_("List"_("l_partkey"_, "l_suppkey"_),
+                                                          "List"_("ps_partkey"_,
+                                                                  "ps_suppkey"_)))),
+                                    "Where"_("Greater"_("ps_availqty"_, "quantity_threshold"_))),
+                                "As"_("ps_suppkey"_, "ps_suppkey"_)),
+                            "By"_("ps_suppkey"_), "As"_("excess_parts"_, "Count"_("*"_))),
+                        "As"_("ps_suppkey"_, "ps_suppkey"_)),
+                    "Project"_(
+                        "Join"_(nation("CANADA"),
+                                "Project"_("SUPPLIER"_,
+                                           "As"_("s_suppkey"_, "s_suppkey"_, "s_name"_, "s_name"_,
+                                                 "s_address"_, "s_address"_, "s_nationkey"_,
+                                                 "s_nationkey"_)),
+                                "Where"_("Equal"_("n_nationkey"_, "s_nationkey"_))),
+                        "As"_("s_suppkey"_, "s_suppkey"_, "s_name"_, "s_name"_, "s_address"_,
+                              "s_address"_)),
+                    "Where"_("Equal"_("ps_suppkey"_, "s_suppkey"_))),
+                "As"_("s_name"_, "s_name"_, "s_address"_, "s_address"_)),
+            "By"_("s_name"_)));
 
-  auto error_found = [](auto&& result, auto const& queryName) {
-    if(!std::holds_alternative<boss::ComplexExpression>(result)) {
-      return false;
-    }
-    if(std::get<boss::ComplexExpression>(result).getHead() == "Table"_) {
-      return false;
-    }
-    if(std::get<boss::ComplexExpression>(result).getHead() == "List"_) {
-      return false;
-    }
-    std::cout << queryName << " Error: "
-              << (VERY_VERBOSE_QUERY_OUTPUT ? std::move(result)
-                                            : utilities::injectDebugInfoToSpans(std::move(result)))
-              << std::endl;
-    return true;
-  };
+    // Q21: number of distinct suppliers of each order (keyed as <prefix>_orderkey)
+    auto orderSuppliers = [](boss::Expression&& lineItems, char const* orderKey,
+                             char const* numSuppliers) {
+      return "Project"_(
+          "Group"_("Group"_(std::move(lineItems), "By"_("l_orderkey"_, "l_suppkey"_),
+                            "As"_("supplier_lines"_, "Count"_("*"_))),
+                   "By"_("l_orderkey"_), "As"_(boss::Symbol(numSuppliers), "Count"_("*"_))),
+          "As"_(boss::Symbol(orderKey), "l_orderkey"_, boss::Symbol(numSuppliers),
+                boss::Symbol(numSuppliers)));
+    };
+    auto lateLineItems = []() {
+      return "Select"_("Project"_("LINEITEM"_, "As"_("l_orderkey"_, "l_orderkey"_, "l_suppkey"_,
+                                                     "l_suppkey"_, "l_commitdate"_,
+                                                     "l_commitdate"_, "l_receiptdate"_,
+                                                     "l_receiptdate"_)),
+                       "Where"_("Greater"_("l_receiptdate"_, "l_commitdate"_)));
+    };
 
-  auto const& queryName = tpchQueryNames().find(queryIdx)->second;
-  auto const& query = tpchQueries().find(queryIdx)->second;
-
-  if(VERBOSE_QUERY_OUTPUT) {
-    auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-    if(!error_found(result, queryName)) {
-      std::cout << "BOSS " << queryName << " output = "
-                << (VERY_VERBOSE_QUERY_OUTPUT
-                        ? std::move(result)
-                        : utilities::injectDebugInfoToSpans(std::move(result)))
-                << std::endl;
-    }
-  }
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q21),
+        "Top"_(
+            "Group"_(
+                "Project"_(
+                    "Select"_(
+                        "Join"_(
+                            // NOT EXISTS (another late supplier): the only late supplier
+                            orderSuppliers(lateLineItems(), "late_orderkey", "late_suppliers"),
+                            "Select"_(
+                                "Join"_(
+                                    // EXISTS (another supplier): more than one supplier
+                                    orderSuppliers("Project"_("LINEITEM"_,
+                                                              "As"_("l_orderkey"_, "l_orderkey"_,
+                                                                    "l_suppkey"_, "l_suppkey"_)),
+                                                   "all_orderkey", "all_suppliers"),
+                                    "Project"_(
+                                        "Join"_(
+                                            "Project"_(
+                                                "Select"_("Project"_("ORDERS"_,
+                                                                     "As"_("o_orderkey"_,
+                                                                           "o_orderkey"_,
+                                                                           "o_orderstatus"_,
+                                                                           "o_orderstatus"_)),
+                                                          "Where"_("StringContainsQ"_(
+                                                              "o_orderstatus"_, "F"))),
+                                                "As"_("o_orderkey"_, "o_orderkey"_)),
+                                            "Project"_(
+                                                "Join"_(
+                                                    "Project"_(
+                                                        "Join"_(nation("SAUDI ARABIA"),
+                                                                "Project"_("SUPPLIER"_,
+                                                                           "As"_("s_suppkey"_,
+                                                                                 "s_suppkey"_,
+                                                                                 "s_name"_,
+                                                                                 "s_name"_,
+                                                                                 "s_nationkey"_,
+                                                                                 "s_nationkey"_)),
+                                                                "Where"_("Equal"_(
+                                                                    "n_nationkey"_,
+                                                                    "s_nationkey"_))),
+                                                        "As"_("s_suppkey"_, "s_suppkey"_,
+                                                              "s_name"_, "s_name"_)),
+                                                    lateLineItems(),
+                                                    "Where"_("Equal"_("s_suppkey"_,
+                                                                      "l_suppkey"_))),
+                                                "As"_("s_name"_, "s_name"_, "l_orderkey"_,
+                                                      "l_orderkey"_)),
+                                            "Where"_("Equal"_("o_orderkey"_, "l_orderkey"_))),
+                                        "As"_("s_name"_, "s_name"_, "l_orderkey"_,
+                                              "l_orderkey"_)),
+                                    "Where"_("Equal"_("all_orderkey"_, "l_orderkey"_))),
+                                "Where"_("Greater"_("all_suppliers"_, 1))),
+                            "Where"_("Equal"_("late_orderkey"_, "l_orderkey"_))),
+                        "Where"_("Equal"_("late_suppliers"_, 1))),
+                    "As"_("s_name"_, "s_name"_)),
+                "By"_("s_name"_), "As"_("numwait"_, "Count"_("*"_))),
+            "By"_("numwait"_, "desc"_, "s_name"_), 100));
 
-  bool failed = false;
+    // Q22: customers of the selected countries with an above-average positive balance. The
+    // country code (the first two characters of c_phone) is c_nationkey + 10 in TPC-H data.
+    auto selectedCountries = []() {
+      return "Or"_("Equal"_("c_nationkey"_, 3), "Equal"_("c_nationkey"_, 21), // NOLINT
+                   "Equal"_("c_nationkey"_, 13), "Equal"_("c_nationkey"_, 19), // NOLINT
+                   "Equal"_("c_nationkey"_, 20), "Equal"_("c_nationkey"_, 8),  // NOLINT
+                   "Equal"_("c_nationkey"_, 7));                               // NOLINT
+    };
+    auto wealthyCustomers = [&selectedCountries]() {
+      return "Project"_(
+          "Select"_(
+              "Project"_("CUSTOMER"_, "As"_("c_custkey"_, "c_custkey"_, "c_nationkey"_,
+                                            "c_nationkey"_, "c_acctbal"_, "c_acctbal"_)),
+              "Where"_("And"_(
+                  selectedCountries(),
+                  "Greater"_("c_acctbal"_,
+                             "Group"_("Select"_("Project"_("CUSTOMER"_,
+                                                           "As"_("c_nationkey"_, "c_nationkey"_,
+                                                                 "c_acctbal"_, "c_acctbal"_)),
+                                                "Where"_("And"_("Greater"_("c_acctbal"_, 0.0),
+                                                                selectedCountries()))),
+                                      "Avg"_("c_acctbal"_)))))),
+          "As"_("c_custkey"_, "c_custkey"_, "cntrycode"_, "Plus"_("c_nationkey"_, 10),
+                "c_acctbal"_, "c_acctbal"_));
+    };
 
-  for(int i = VERBOSE_QUERY_OUTPUT; i < BENCHMARK_NUM_WARMPUP_ITERATIONS; ++i) {
-    auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-    if(error_found(result, queryName)) {
-      failed = true;
-      break;
-    }
+    queries.try_emplace(
+        static_cast<int>(DATASETS::TPCH) + static_cast<int>(TPCH_Q22),
+        "Order"_(
+            "Project"_(
+                "Join"_(
+                    // NOT EXISTS (orders): all candidates minus the candidates with orders
+                    "Project"_(
+                        "Group"_(
+                            "Join"_("Project"_("Group"_("Project"_("ORDERS"_, "As"_("o_custkey"_,
+                                                                                    "o_custkey"_)),
+                                                        "By"_("o_custkey"_),
+                                                        "As"_("orders"_, "Count"_("*"_))),
+                                               "As"_("o_custkey"_, "o_custkey"_)),
+                                    wealthyCustomers(),
+                                    "Where"_("Equal"_("o_custkey"_, "c_custkey"_))),
+                            "By"_("cntrycode"_),
+                            "As"_("ordering_custs"_, "Count"_("*"_), "ordering_acctbal"_,
+                                  "Sum"_("c_acctbal"_))),
+                        "As"_("ordering_cntrycode"_, "cntrycode"_, "ordering_custs"_,
+                              "ordering_custs"_, "ordering_acctbal"_, "ordering_acctbal"_)),
+                    "Group"_(wealthyCustomers(), "By"_("cntrycode"_),
+                             "As"_("all_custs"_, "Count"_("*"_), "all_acctbal"_,
+                                   "Sum"_("c_acctbal"_))),
+                    "Where"_("Equal"_("ordering_cntrycode"_, "cntrycode"_))),
+                "As"_("cntrycode"_, "cntrycode"_, "numcust"_,
+                      "Minus"_("all_custs"_, "ordering_custs"_), "totacctbal"_,
+                      "Minus"_("all_acctbal"_, "ordering_acctbal"_))),
+            "By"_("cntrycode"_)));
   }
+  return queries;
+}
 
-  vtune.startSampling(queryName + " - BOSS");
-  for(auto _ : state) { // NOLINT
-    if(!failed) {
-      auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-      if(error_found(result, queryName)) {
-        failed = true;
-      }
-      benchmark::DoNotOptimize(result);
-    }
+void TPCH_Benchmark(benchmark::State& state, int queryIdx, int dataSize, bool generateInProcess) {
+  if(state.thread_index() == 0 && !DISPATCH_FLOOR) {
+    initStorageEngine_TPCH(dataSize, generateInProcess);
   }
-  vtune.stopSampling();
+
+  auto const& queryName = tpchQueryNames().find(queryIdx)->second;
+  auto const& query = tpchQueries(dataSize).find(queryIdx)->second;
+
+  runQueryBenchmark(state, queryName, query);
+  auto [numTuples, numBytes] = tpchScannedTuplesAndBytes(query);
+  utilities::reportPerfCounters(state, numTuples);
+  utilities::reportThroughput(state, numTuples, numBytes);
 }
 
-void initStorageEngine_tpch_q6_clustering(int dataSize, uint32_t spreadInCluster) {
+// Builds LINEITEM_CLUSTERED from the given LINEITEM columns only. The clustered columns are
+// allocated once per data set (and owned by the harness) and rewritten in place for every spread.
+void initStorageEngine_tpch_q6_clustering(int dataSize, uint64_t spreadInCluster,
+                                          std::vector<boss::Symbol> const& columnNames) {
   auto evalStorage = [](boss::Expression&& expression) mutable {
     return boss::evaluate("EvaluateInEngines"_("List"_(librariesToTest[0]), std::move(expression)));
   };
@@ -415,7 +1509,13 @@ void initStorageEngine_tpch_q6_clustering(int dataSize, uint32_t spreadInCluster
     }
   };
 
-  if(latestDataSet == "tpch_q6_clustering_sweep" && latestDataSize == dataSize) {
+  auto traceScope = traceEvents.scope(__func__, "storage");
+  traceScope.argument("dataSize", dataSize);
+  traceScope.argument("spreadInCluster", static_cast<int64_t>(spreadInCluster));
+
+  bool reuseBuffers = latestDataSet == "tpch_q6_clustering_sweep" && latestDataSize == dataSize &&
+                      latestDataSetSpans.size() == columnNames.size();
+  if(reuseBuffers) {
     checkForErrors(evalStorage("DropTable"_("LINEITEM_CLUSTERED"_)));
   } else {
     resetStorageEngine();
@@ -424,84 +1524,75 @@ void initStorageEngine_tpch_q6_clustering(int dataSize, uint32_t spreadInCluster
                        "l_quantity"_, "l_extendedprice"_, "l_discount"_, "l_tax"_, "l_returnflag"_,
                        "l_linestatus"_, "l_shipdate"_, "l_commitdate"_, "l_receiptdate"_,
                        "l_shipinstruct"_, "l_shipmode"_, "l_comment"_)));
-    std::string path = "../data/tpch_" + std::to_string(dataSize) + "MB/lineitem.tbl";
-    checkForErrors(evalStorage("Load"_("LINEITEM"_, path)));
+    loadTPCHTable(dataSize, "lineitem", "LINEITEM"_,
+                  tpchGeneration::discoverDateEncoding(evalStorage));
   }
 
   latestDataSet = "tpch_q6_clustering_sweep";
   latestDataSize = dataSize;
 
-  auto originalTable = evalStorage(("LINEITEM"_));
-  auto table = originalTable.clone(boss::expressions::CloneReason::EXPRESSION_SUBSTITUTION);
-
-  std::string filepath = "../data/tpch_" + std::to_string(dataSize) + "MB/lineitem.tbl";
-  auto n = static_cast<int>(getNumberOfRowsInTable(filepath));
-  const auto clusteringOrder = generateClusteringOrder(n, static_cast<int>(spreadInCluster));
-
-  auto& originalColumns = std::get<ComplexExpression>(originalTable).getDynamicArguments();
-
-  auto numColumns = std::get<ComplexExpression>(table).getDynamicArguments().size();
-  auto columns = std::move(std::get<ComplexExpression>(table)).getDynamicArguments();
-
-  for(auto i = 0; i < static_cast<int>(numColumns); ++i) {
-    auto& originalColumn = originalColumns.at(i);
-    auto& originalList = std::get<ComplexExpression>(originalColumn).getDynamicArguments().at(0);
-    auto& originalSpan = std::get<ComplexExpression>(originalList).getSpanArguments().at(0);
-
-    auto column = std::get<ComplexExpression>(std::move(columns.at(i)));
-    auto [head, unused_, dynamics, spans] = std::move(column).decompose();
-    auto list = std::get<ComplexExpression>(std::move(dynamics.at(0)));
-    auto [listHead, listUnused_, listDynamics, listSpans] = std::move(list).decompose();
-
-    listSpans.at(0) = std::visit(
-        [&clusteringOrder, &originalSpan,
-         n]<typename T>(boss::Span<T>&& typedSpan) -> SpanArgument {
-          if constexpr(std::is_same_v<T, int64_t> || std::is_same_v<T, double_t> ||
-                       std::is_same_v<T, std::string>) {
-            return applyClusteringOrderToSpan(std::get<boss::Span<T>>(originalSpan),
-                                              std::move(typedSpan), clusteringOrder, n);
-          } else {
-            throw std::runtime_error("unsupported column type in predicate");
-          }
-        },
-        std::move(listSpans.at(0)));
-    dynamics.at(0) =
-        ComplexExpression(std::move(listHead), {}, std::move(listDynamics), std::move(listSpans));
-    columns.at(i) = ComplexExpression(std::move(head), {}, std::move(dynamics), std::move(spans));
+  ExpressionArguments projection;
+  for(auto const& name : columnNames) {
+    projection.emplace_back(name);
+    projection.emplace_back(name);
+  }
+  auto originalTable = evalStorage(
+      "Project"_("LINEITEM"_, ComplexExpression("As"_, {}, std::move(projection), {})));
+  auto const& originalColumns = std::get<ComplexExpression>(originalTable).getDynamicArguments();
+
+  auto originalSpan = [&originalColumns](size_t i) -> SpanArgument const& {
+    auto const& list = std::get<ComplexExpression>(originalColumns.at(i)).getDynamicArguments();
+    return std::get<ComplexExpression>(list.at(0)).getSpanArguments().at(0);
+  };
+
+  if(!reuseBuffers) {
+    for(size_t i = 0; i < columnNames.size(); ++i) {
+      latestDataSetSpans.emplace_back(std::visit(
+          []<typename T>(boss::Span<T> const& typedSpan) -> SpanArgument {
+            using Element = std::remove_const_t<T>;
+            if constexpr(std::is_same_v<Element, std::string>) {
+              return boss::Span<Element>(std::vector<Element>(typedSpan.size()));
+            } else if constexpr(std::is_trivially_destructible_v<Element>) {
+              return utilities::allocateAlignedSpan<Element>(typedSpan.size());
+            } else {
+              throw std::runtime_error("unsupported column type for clustering");
+            }
+          },
+          originalSpan(i)));
+    }
+  }
+
+  auto clusteringScope = traceEvents.scope("cluster", "generation");
+  auto n = std::visit([](auto const& typedSpan) { return typedSpan.size(); }, originalSpan(0));
+  std::vector<std::pair<SpanArgument const*, SpanArgument*>> spans;
+  for(size_t i = 0; i < columnNames.size(); ++i) {
+    spans.emplace_back(&originalSpan(i), &latestDataSetSpans.at(i));
+  }
+  applyClusteringOrderToSpans(spans, n, spreadInCluster);
+  clusteringScope.end();
+
+  ExpressionArguments columns;
+  for(size_t i = 0; i < columnNames.size(); ++i) {
+    SpanArguments spans;
+    spans.emplace_back(utilities::shallowCopy(latestDataSetSpans.at(i)));
+    ExpressionArguments list;
+    list.emplace_back(ComplexExpression("List"_, {}, {}, std::move(spans)));
+    columns.emplace_back(ComplexExpression(columnNames.at(i), {}, std::move(list), {}));
   }
 
+  auto loadScope = traceEvents.scope("LoadDataTable", "storage");
   checkForErrors(evalStorage("CreateTable"_("LINEITEM_CLUSTERED"_)));
   checkForErrors(evalStorage("LoadDataTable"_(
       "LINEITEM_CLUSTERED"_, ComplexExpression("Data"_, {}, std::move(columns), {}))));
 }
 
 void tpch_q6_clustering_sweep_Benchmark(benchmark::State& state, int dataSize) {
-  uint32_t spreadInCluster = state.range(0);
-  initStorageEngine_tpch_q6_clustering(dataSize, spreadInCluster);
-
-  auto eval = [](auto&& expression) {
-    boss::expressions::ExpressionSpanArguments spans;
-    spans.emplace_back(boss::expressions::Span<std::string>(librariesToTest));
-    return boss::evaluate("EvaluateInEngines"_(
-        boss::ComplexExpression("List"_, {}, {}, std::move(spans)), std::move(expression)));
-  };
-
-  auto error_found = [](auto&& result, auto const& queryName) {
-    if(!std::holds_alternative<boss::ComplexExpression>(result)) {
-      return false;
-    }
-    if(std::get<boss::ComplexExpression>(result).getHead() == "Table"_) {
-      return false;
-    }
-    if(std::get<boss::ComplexExpression>(result).getHead() == "List"_) {
-      return false;
-    }
-    std::cout << queryName << " Error: "
-              << (VERY_VERBOSE_QUERY_OUTPUT ? std::move(result)
-                                            : utilities::injectDebugInfoToSpans(std::move(result)))
-              << std::endl;
-    return true;
-  };
+  auto spreadInCluster = static_cast<uint64_t>(state.range(0));
+  if(state.thread_index() == 0 && !DISPATCH_FLOOR) {
+    initStorageEngine_tpch_q6_clustering(
+        dataSize, spreadInCluster,
+        {"l_quantity"_, "l_discount"_, "l_shipdate"_, "l_extendedprice"_});
+  }
 
   auto const& queryName = tpchQueryNames().find(TPCH_QUERIES::TPCH_Q6)->second;
   auto const& query = boss::Expression{"Group"_(
@@ -518,36 +1609,15 @@ void tpch_q6_clustering_sweep_Benchmark(benchmark::State& state, int dataSize) {
           "As"_("revenue"_, "Times"_("l_extendedprice"_, "l_discount"_))),
       "Sum"_("revenue"_))};
 
-  if(VERBOSE_QUERY_OUTPUT) {
-    auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-    if(!error_found(result, queryName)) {
-      std::cout << "BOSS " << queryName << " output = "
-                << (VERY_VERBOSE_QUERY_OUTPUT
-                        ? std::move(result)
-                        : utilities::injectDebugInfoToSpans(std::move(result)))
-                << std::endl;
-    }
-  }
+  runQueryBenchmark(state, queryName, query);
 
-  bool failed = false;
-
-  for(int i = VERBOSE_QUERY_OUTPUT; i < BENCHMARK_NUM_WARMPUP_ITERATIONS; ++i) {
-    auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-    if(error_found(result, queryName)) {
-      failed = true;
-      break;
-    }
-  }
-
-  vtune.startSampling(queryName + " - BOSS");
-  for(auto _ : state) { // NOLINT
-    if(!failed) {
-      auto result = eval(utilities::shallowCopy(std::get<boss::ComplexExpression>(query)));
-      if(error_found(result, queryName)) {
-        failed = true;
-      }
-      benchmark::DoNotOptimize(result);
-    }
+  // the query scans all of LINEITEM_CLUSTERED, whose columns the harness owns
+  int64_t numTuples = 0;
+  int64_t numBytes = 0;
+  for(auto const& span : latestDataSetSpans) {
+    numTuples = spanSize(span);
+    numBytes += utilities::spanBytes(span);
   }
-  vtune.stopSampling();
+  utilities::reportPerfCounters(state, numTuples);
+  utilities::reportThroughput(state, numTuples, numBytes);
 }
\ No newline at end of file
@@ -0,0 +1,842 @@
+#ifndef TPCHGENERATION_CPP
+#define TPCHGENERATION_CPP
+
+#include "dataGeneration.cpp"
+#include "utilities.cpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+// In-process, multi-threaded TPC-H data generator. It follows the dbgen value distributions
+// (key layouts, foreign keys, price formulas, dates, flags and the TPC-H word lists) and emits the
+// typed columns of all eight tables directly as spans for LoadDataTable, at any scale factor.
+// Text columns use a simplified version of the dbgen text grammar. Every row is generated from
+// its own counter-based random stream, so the data does not depend on the number of threads.
+namespace tpchGeneration {
+
+using SpanArgument = boss::DefaultExpressionSystem::ExpressionSpanArgument;
+using SpanArguments = boss::DefaultExpressionSystem::ExpressionSpanArguments;
+
+constexpr size_t ROWS_PER_CHUNK = 1 << 14;
+constexpr int64_t MAX_LINEITEMS_PER_ORDER = 7;
+
+// Independent random streams per table
+enum SEEDS : uint64_t {
+  PART_SEED = 101,
+  PARTSUPP_SEED = 102,
+  SUPPLIER_SEED = 103,
+  CUSTOMER_SEED = 104,
+  ORDERS_SEED = 105,
+  LINEITEM_SEED = 106,
+  NATION_SEED = 107,
+  REGION_SEED = 108
+};
+
+class RowRandom {
+public:
+  RowRandom(uint64_t seed, uint64_t row) : state(counterBasedRandom(seed, row)) {}
+  int64_t uniform(int64_t lowerBound, int64_t upperBound) {
+    return boundedRandom<int64_t>(counterBasedRandom(state, counter++), lowerBound, upperBound);
+  }
+  template <size_t N> std::string_view pick(std::array<std::string_view, N> const& words) {
+    return words[static_cast<size_t>(uniform(0, N - 1))];
+  }
+
+private:
+  uint64_t state;
+  uint64_t counter = 0;
+};
+
+// days since 1970-01-01 (proleptic Gregorian calendar)
+constexpr int64_t daysFromCivil(int64_t year, int64_t month, int64_t day) {
+  year -= month <= 2 ? 1 : 0;
+  auto era = (year >= 0 ? year : year - 399) / 400;
+  auto yearOfEra = year - era * 400;
+  auto dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  auto dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + dayOfEra - 719468;
+}
+
+constexpr int64_t START_DATE = daysFromCivil(1992, 1, 1);
+constexpr int64_t CURRENT_DATE = daysFromCivil(1995, 6, 17);
+constexpr int64_t END_DATE = daysFromCivil(1998, 12, 31);
+
+// How the storage engine represents dates (discovered by evaluating "DateObject"_ in the engine)
+struct DateEncoding {
+  bool asInt32 = false;
+  int64_t epoch = 0;  // value of 1970-01-01
+  int64_t perDay = 1; // increment per day
+
+  std::string tag() const {
+    return std::string("dates=") + (asInt32 ? "int32" : "int64") + ":" + std::to_string(epoch) +
+           "+" + std::to_string(perDay);
+  }
+};
+
+// A generated column, stored in partitions of utilities::LOAD_PARTITION_ROWS rows
+template <typename T> class Column {
+public:
+  T& operator[](size_t i) const {
+    return partitions[i / utilities::LOAD_PARTITION_ROWS][i % utilities::LOAD_PARTITION_ROWS];
+  }
+  std::vector<T*> partitions;
+};
+
+// A date column in the engine's representation
+class DateColumn {
+public:
+  DateColumn(DateEncoding const& encoding, Column<int32_t> int32Column,
+             Column<int64_t> int64Column)
+      : encoding(encoding), int32Column(std::move(int32Column)),
+        int64Column(std::move(int64Column)) {}
+  void set(size_t i, int64_t days) const {
+    auto value = encoding.epoch + days * encoding.perDay;
+    if(encoding.asInt32) {
+      int32Column[i] = static_cast<int32_t>(value);
+    } else {
+      int64Column[i] = value;
+    }
+  }
+
+private:
+  DateEncoding encoding;
+  Column<int32_t> int32Column;
+  Column<int64_t> int64Column;
+};
+
+constexpr std::array<std::string_view, 25> NATIONS = {
+    "ALGERIA", "ARGENTINA", "BRAZIL", "CANADA", "EGYPT", "ETHIOPIA", "FRANCE", "GERMANY", "INDIA",
+    "INDONESIA", "IRAN", "IRAQ", "JAPAN", "JORDAN", "KENYA", "MOROCCO", "MOZAMBIQUE", "PERU",
+    "CHINA", "ROMANIA", "SAUDI ARABIA", "VIETNAM", "RUSSIA", "UNITED KINGDOM", "UNITED STATES"};
+constexpr std::array<int64_t, 25> NATION_REGIONS = {
+    0, 1, 1, 1, 4, 0, 3, 3, 2, 2, 4, 4, 2, 4, 0, 0, 0, 1, 2, 3, 4, 2, 3, 3, 1};
+constexpr std::array<std::string_view, 5> REGIONS = {
+    "AFRICA", "AMERICA", "ASIA", "EUROPE", "MIDDLE EAST"};
+constexpr std::array<std::string_view, 92> COLORS = {
+    "almond", "antique", "aquamarine", "azure", "beige", "bisque", "black", "blanched", "blue",
+    "blush", "brown", "burlywood", "burnished", "chartreuse", "chiffon", "chocolate", "coral",
+    "cornflower", "cornsilk", "cream", "cyan", "dark", "deep", "dim", "dodger", "drab", "firebrick",
+    "floral", "forest", "frosted", "gainsboro", "ghost", "goldenrod", "green", "grey", "honeydew",
+    "hot", "indian", "ivory", "khaki", "lace", "lavender", "lawn", "lemon", "light", "lime",
+    "linen", "magenta", "maroon", "medium", "metallic", "midnight", "mint", "misty", "moccasin",
+    "navajo", "navy", "olive", "orange", "orchid", "pale", "papaya", "peach", "peru", "pink",
+    "plum", "powder", "puff", "purple", "red", "rose", "rosy", "royal", "saddle", "salmon", "sandy",
+    "seashell", "sienna", "sky", "slate", "smoke", "snow", "spring", "steel", "tan", "thistle",
+    "tomato", "turquoise", "violet", "wheat", "white", "yellow"};
+constexpr std::array<std::string_view, 6> TYPE_SIZES = {
+    "STANDARD", "SMALL", "MEDIUM", "LARGE", "ECONOMY", "PROMO"};
+constexpr std::array<std::string_view, 5> TYPE_FINISHES = {
+    "ANODIZED", "BURNISHED", "PLATED", "POLISHED", "BRUSHED"};
+constexpr std::array<std::string_view, 5> TYPE_MATERIALS = {
+    "TIN", "NICKEL", "BRASS", "STEEL", "COPPER"};
+constexpr std::array<std::string_view, 5> CONTAINER_SIZES = {"SM", "LG", "MED", "JUMBO", "WRAP"};
+constexpr std::array<std::string_view, 8> CONTAINER_TYPES = {
+    "CASE", "BOX", "BAG", "JAR", "PKG", "PACK", "CAN", "DRUM"};
+constexpr std::array<std::string_view, 5> SEGMENTS = {
+    "AUTOMOBILE", "BUILDING", "FURNITURE", "MACHINERY", "HOUSEHOLD"};
+constexpr std::array<std::string_view, 5> PRIORITIES = {
+    "1-URGENT", "2-HIGH", "3-MEDIUM", "4-NOT SPECIFIED", "5-LOW"};
+constexpr std::array<std::string_view, 4> INSTRUCTIONS = {
+    "DELIVER IN PERSON", "COLLECT COD", "NONE", "TAKE BACK RETURN"};
+constexpr std::array<std::string_view, 7> SHIP_MODES = {
+    "REG AIR", "AIR", "RAIL", "SHIP", "TRUCK", "MAIL", "FOB"};
+
+constexpr std::array<std::string_view, 45> NOUNS = {
+    "foxes", "ideas", "theodolites", "pinto beans", "instructions", "dependencies", "excuses",
+    "platelets", "asymptotes", "courts", "dolphins", "multipliers", "sauternes", "warthogs",
+    "frets", "dinos", "attainments", "somas", "Tiresias", "patterns", "forges", "braids",
+    "hockey players", "frays", "warhorses", "dugouts", "notornis", "epitaphs", "pearls", "tithes",
+    "waters", "orbits", "gifts", "sheaves", "depths", "sentiments", "decoys", "realms", "pains",
+    "grouches", "escapades", "packages", "requests", "accounts", "deposits"};
+constexpr std::array<std::string_view, 40> VERBS = {
+    "sleep", "wake", "are", "cajole", "haggle", "nag", "use", "boost", "affix", "detect",
+    "integrate", "maintain", "nod", "was", "lose", "sublate", "solve", "thrash", "promise",
+    "engage", "hinder", "print", "x-ray", "breach", "eat", "grow", "impress", "mold", "poach",
+    "serve", "run", "dazzle", "snooze", "doze", "unwind", "kindle", "play", "hang", "believe",
+    "doubt"};
+constexpr std::array<std::string_view, 29> ADJECTIVES = {
+    "furious", "sly", "careful", "blithe", "quick", "fluffy", "slow", "quiet", "ruthless", "thin",
+    "close", "dogged", "daring", "brave", "stealthy", "permanent", "enticing", "idle", "busy",
+    "regular", "final", "ironic", "even", "bold", "silent", "special", "pending", "express",
+    "unusual"};
+constexpr std::array<std::string_view, 28> ADVERBS = {
+    "sometimes", "always", "never", "furiously", "slyly", "carefully", "blithely", "quickly",
+    "fluffily", "slowly", "quietly", "ruthlessly", "thinly", "closely", "doggedly", "daringly",
+    "bravely", "stealthily", "permanently", "enticingly", "idly", "busily", "regularly", "finally",
+    "ironically", "evenly", "boldly", "silently"};
+constexpr std::array<std::string_view, 24> PREPOSITIONS = {
+    "about", "above", "according to", "across", "after", "against", "along", "among", "around",
+    "at", "atop", "before", "behind", "beneath", "beside", "between", "beyond", "by", "despite",
+    "during", "except", "for", "from", "into"};
+
+// Text from a simplified dbgen grammar ("adjective noun verb adverb preposition the ..."),
+// truncated to a random length in [minLength, maxLength]
+static std::string text(RowRandom& random, int64_t minLength, int64_t maxLength) {
+  auto length = static_cast<size_t>(random.uniform(minLength, maxLength));
+  std::string result;
+  result.reserve(length + 32);
+  while(result.size() < length) {
+    switch(random.uniform(0, 5)) {
+    case 0:
+      result.append(random.pick(ADJECTIVES));
+      break;
+    case 1:
+    case 2:
+      result.append(random.pick(NOUNS));
+      break;
+    case 3:
+      result.append(random.pick(VERBS));
+      break;
+    case 4:
+      result.append(random.pick(ADVERBS));
+      break;
+    default:
+      result.append(random.pick(PREPOSITIONS)).append(" the");
+      break;
+    }
+    result.push_back(' ');
+  }
+  result.resize(length);
+  return result;
+}
+
+static std::string randomAddress(RowRandom& random) {
+  static constexpr std::string_view characters =
+      "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ,";
+  std::string result(static_cast<size_t>(random.uniform(10, 40)), ' ');
+  for(auto& character : result) {
+    character = characters[static_cast<size_t>(random.uniform(0, characters.size() - 1))];
+  }
+  return result;
+}
+
+static std::string phone(RowRandom& random, int64_t nationKey) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%02d-%03d-%03d-%04d", static_cast<int>(nationKey + 10),
+                static_cast<int>(random.uniform(100, 999)),
+                static_cast<int>(random.uniform(100, 999)),
+                static_cast<int>(random.uniform(1000, 9999)));
+  return buffer;
+}
+
+static std::string numbered(std::string_view prefix, int64_t number) {
+  char buffer[16];
+  std::snprintf(buffer, sizeof(buffer), "%09lld", static_cast<long long>(number));
+  return std::string(prefix) + buffer;
+}
+
+// prices and balances are generated in cents, like dbgen
+static double_t money(int64_t cents) { return static_cast<double_t>(cents) / 100.0; }
+
+struct ScaleFactor {
+  explicit ScaleFactor(double scale) : scale(scale) {}
+  int64_t rows(int64_t base) const {
+    return std::max<int64_t>(1, static_cast<int64_t>(std::llround(base * scale)));
+  }
+  int64_t parts() const { return rows(200000); }
+  int64_t suppliers() const { return rows(10000); }
+  int64_t customers() const { return rows(150000); }
+  int64_t orders() const { return rows(1500000); }
+  double scale;
+};
+
+static double_t retailPrice(int64_t partKey) {
+  return money(90000 + ((partKey / 10) % 20001) + 100 * (partKey % 1000));
+}
+
+// i-th (0..3) supplier of a part (dbgen's PARTSUPP bridge)
+static int64_t partSupplier(int64_t partKey, int64_t i, int64_t suppliers) {
+  return (partKey + (i * ((suppliers / 4) + (partKey - 1) / suppliers))) % suppliers + 1;
+}
+
+static int64_t orderKey(int64_t orderIndex) { return (orderIndex / 8) * 32 + orderIndex % 8 + 1; }
+
+// The line items of an order are needed by both ORDERS (total price and status) and LINEITEM, so
+// they are derived from their own random streams (by order index and line number)
+struct LineItem {
+  int64_t partKey;
+  int64_t suppKey;
+  int64_t quantity;
+  double_t extendedPrice;
+  int64_t discount; // in hundredths
+  int64_t tax;      // in hundredths
+  int64_t shipDate;
+  int64_t commitDate;
+  int64_t receiptDate;
+};
+
+static RowRandom lineItemRandom(int64_t orderIndex, int64_t lineNumber) {
+  return {LINEITEM_SEED, static_cast<uint64_t>(orderIndex * (MAX_LINEITEMS_PER_ORDER + 1) +
+                                               lineNumber)};
+}
+
+static int64_t numLineItems(int64_t orderIndex) {
+  return lineItemRandom(orderIndex, 0).uniform(1, MAX_LINEITEMS_PER_ORDER);
+}
+
+static LineItem lineItem(ScaleFactor const& scaleFactor, int64_t orderDate, RowRandom& random) {
+  LineItem item{};
+  item.partKey = random.uniform(1, scaleFactor.parts());
+  item.suppKey = partSupplier(item.partKey, random.uniform(0, 3), scaleFactor.suppliers());
+  item.quantity = random.uniform(1, 50);
+  item.extendedPrice = static_cast<double_t>(item.quantity) * retailPrice(item.partKey);
+  item.discount = random.uniform(0, 10);
+  item.tax = random.uniform(0, 8);
+  item.shipDate = orderDate + random.uniform(1, 121);
+  item.commitDate = orderDate + random.uniform(30, 90);
+  item.receiptDate = item.shipDate + random.uniform(1, 30);
+  return item;
+}
+
+// Only two thirds of the customers place orders (dbgen skips keys divisible by 3)
+static int64_t orderingCustomer(RowRandom& random, int64_t customers) {
+  auto k = random.uniform(1, std::max<int64_t>(1, customers * 2 / 3));
+  return std::min(customers, k + (k - 1) / 2);
+}
+
+// Columns of the "Data"_ expression for LoadDataTable, filled in parallel. Tables larger than
+// utilities::LOAD_PARTITION_ROWS are emitted as multiple partitions (spans) per column.
+class TableBuilder {
+public:
+  explicit TableBuilder(size_t rows) : rows(rows) {}
+
+  template <typename T> Column<T> numeric(std::string const& name) {
+    Column<T> column;
+    SpanArguments partitions;
+    for(size_t begin = 0; begin < std::max<size_t>(rows, 1);
+        begin += utilities::LOAD_PARTITION_ROWS) {
+      auto span = utilities::allocateAlignedSpan<T>(
+          std::min(rows - begin, utilities::LOAD_PARTITION_ROWS));
+      column.partitions.push_back(span.begin());
+      partitions.emplace_back(std::move(span));
+    }
+    columns.emplace_back(name, std::move(partitions));
+    return column;
+  }
+  Column<std::string> strings(std::string const& name) {
+    Column<std::string> column;
+    auto& partitions = stringColumns.emplace_back(columns.size(), std::vector<Strings>()).second;
+    for(size_t begin = 0; begin < std::max<size_t>(rows, 1);
+        begin += utilities::LOAD_PARTITION_ROWS) {
+      partitions.emplace_back(std::min(rows - begin, utilities::LOAD_PARTITION_ROWS));
+      column.partitions.push_back(partitions.back().data());
+    }
+    columns.emplace_back(name, SpanArguments());
+    return column;
+  }
+  DateColumn date(std::string const& name, DateEncoding const& encoding) {
+    if(encoding.asInt32) {
+      return {encoding, numeric<int32_t>(name), {}};
+    }
+    return {encoding, {}, numeric<int64_t>(name)};
+  }
+
+  template <typename Func> void forEachRow(Func&& func) {
+    utilities::parallelForChunks(rows, ROWS_PER_CHUNK, [&func](size_t begin, size_t end) {
+      for(auto i = begin; i < end; ++i) {
+        func(i);
+      }
+    });
+  }
+
+  boss::ExpressionArguments build() && {
+    for(auto& [index, partitions] : stringColumns) {
+      for(auto& partition : partitions) {
+        columns[index].second.emplace_back(boss::Span<std::string>(std::move(partition)));
+      }
+    }
+    boss::ExpressionArguments data;
+    for(auto& [name, partitions] : columns) {
+      boss::ExpressionArguments list;
+      list.emplace_back(boss::ComplexExpression("List"_, {}, {}, std::move(partitions)));
+      data.emplace_back(boss::ComplexExpression(boss::Symbol(name), {}, std::move(list), {}));
+    }
+    return data;
+  }
+
+private:
+  using Strings = std::vector<std::string>;
+  size_t rows;
+  std::vector<std::pair<std::string, SpanArguments>> columns;
+  std::vector<std::pair<size_t, std::vector<Strings>>> stringColumns;
+};
+
+static boss::ExpressionArguments generateRegion() {
+  TableBuilder table(REGIONS.size());
+  auto key = table.numeric<int64_t>("r_regionkey");
+  auto name = table.strings("r_name");
+  auto comment = table.strings("r_comment");
+  table.forEachRow([&](size_t i) {
+    RowRandom random(REGION_SEED, i);
+    key[i] = static_cast<int64_t>(i);
+    name[i] = REGIONS[i];
+    comment[i] = text(random, 31, 115);
+  });
+  return std::move(table).build();
+}
+
+static boss::ExpressionArguments generateNation() {
+  TableBuilder table(NATIONS.size());
+  auto key = table.numeric<int64_t>("n_nationkey");
+  auto name = table.strings("n_name");
+  auto regionKey = table.numeric<int64_t>("n_regionkey");
+  auto comment = table.strings("n_comment");
+  table.forEachRow([&](size_t i) {
+    RowRandom random(NATION_SEED, i);
+    key[i] = static_cast<int64_t>(i);
+    name[i] = NATIONS[i];
+    regionKey[i] = NATION_REGIONS[i];
+    comment[i] = text(random, 31, 114);
+  });
+  return std::move(table).build();
+}
+
+static boss::ExpressionArguments generatePart(ScaleFactor const& scaleFactor) {
+  TableBuilder table(static_cast<size_t>(scaleFactor.parts()));
+  auto key = table.numeric<int64_t>("p_partkey");
+  auto name = table.strings("p_name");
+  auto manufacturer = table.strings("p_mfgr");
+  auto brand = table.strings("p_brand");
+  auto type = table.strings("p_type");
+  auto size = table.numeric<int64_t>("p_size");
+  auto container = table.strings("p_container");
+  auto retailPrices = table.numeric<double_t>("p_retailprice");
+  auto comment = table.strings("p_comment");
+  table.forEachRow([&](size_t i) {
+    RowRandom random(PART_SEED, i);
+    key[i] = static_cast<int64_t>(i) + 1;
+    std::array<size_t, 5> colors{};
+    for(size_t c = 0; c < colors.size(); ++c) {
+      do {
+        colors[c] = static_cast<size_t>(random.uniform(0, COLORS.size() - 1));
+      } while(std::find(colors.begin(), colors.begin() + c, colors[c]) != colors.begin() + c);
+      name[i].append(c > 0 ? " " : "").append(COLORS[colors[c]]);
+    }
+    auto m = random.uniform(1, 5);
+    manufacturer[i] = "Manufacturer#" + std::to_string(m);
+    brand[i] = "Brand#" + std::to_string(m) + std::to_string(random.uniform(1, 5));
+    type[i] = std::string(random.pick(TYPE_SIZES)) + " " + std::string(random.pick(TYPE_FINISHES)) +
+              " " + std::string(random.pick(TYPE_MATERIALS));
+    size[i] = random.uniform(1, 50);
+    container[i] =
+        std::string(random.pick(CONTAINER_SIZES)) + " " + std::string(random.pick(CONTAINER_TYPES));
+    retailPrices[i] = retailPrice(key[i]);
+    comment[i] = text(random, 5, 22);
+  });
+  return std::move(table).build();
+}
+
+static boss::ExpressionArguments generateSupplier(ScaleFactor const& scaleFactor) {
+  TableBuilder table(static_cast<size_t>(scaleFactor.suppliers()));
+  auto key = table.numeric<int64_t>("s_suppkey");
+  auto name = table.strings("s_name");
+  auto address = table.strings("s_address");
+  auto nationKey = table.numeric<int64_t>("s_nationkey");
+  auto phones = table.strings("s_phone");
+  auto accountBalance = table.numeric<double_t>("s_acctbal");
+  auto comment = table.strings("s_comment");
+  table.forEachRow([&](size_t i) {
+    RowRandom random(SUPPLIER_SEED, i);
+    key[i] = static_cast<int64_t>(i) + 1;
+    name[i] = numbered("Supplier#", key[i]);
+    address[i] = randomAddress(random);
+    nationKey[i] = random.uniform(0, NATIONS.size() - 1);
+    phones[i] = phone(random, nationKey[i]);
+    accountBalance[i] = money(random.uniform(-99999, 999999));
+    comment[i] = text(random, 25, 100);
+    // 5 in 10000 suppliers have complaints and 5 in 10000 recommendations (used by Q16)
+    auto special = random.uniform(1, 2000);
+    if(special <= 2) {
+      auto note = "Customer " + text(random, 1, 5) + (special == 1 ? " Complaints" : " Recommends");
+      comment[i].replace(static_cast<size_t>(random.uniform(0, comment[i].size() - note.size())),
+                         note.size(), note);
+    }
+  });
+  return std::move(table).build();
+}
+
+static boss::ExpressionArguments generatePartsupp(ScaleFactor const& scaleFactor) {
+  TableBuilder table(static_cast<size_t>(scaleFactor.parts() * 4));
+  auto partKey = table.numeric<int64_t>("ps_partkey");
+  auto suppKey = table.numeric<int64_t>("ps_suppkey");
+  auto availableQuantity = table.numeric<int64_t>("ps_availqty");
+  auto supplyCost = table.numeric<double_t>("ps_supplycost");
+  auto comment = table.strings("ps_comment");
+  table.forEachRow([&](size_t i) {
+    RowRandom random(PARTSUPP_SEED, i);
+    partKey[i] = static_cast<int64_t>(i / 4) + 1;
+    suppKey[i] = partSupplier(partKey[i], static_cast<int64_t>(i % 4), scaleFactor.suppliers());
+    availableQuantity[i] = random.uniform(1, 9999);
+    supplyCost[i] = money(random.uniform(100, 100000));
+    comment[i] = text(random, 49, 198);
+  });
+  return std::move(table).build();
+}
+
+static boss::ExpressionArguments generateCustomer(ScaleFactor const& scaleFactor) {
+  TableBuilder table(static_cast<size_t>(scaleFactor.customers()));
+  auto key = table.numeric<int64_t>("c_custkey");
+  auto name = table.strings("c_name");
+  auto address = table.strings("c_address");
+  auto nationKey = table.numeric<int64_t>("c_nationkey");
+  auto phones = table.strings("c_phone");
+  auto accountBalance = table.numeric<double_t>("c_acctbal");
+  auto segment = table.strings("c_mktsegment");
+  auto comment = table.strings("c_comment");
+  table.forEachRow([&](size_t i) {
+    RowRandom random(CUSTOMER_SEED, i);
+    key[i] = static_cast<int64_t>(i) + 1;
+    name[i] = numbered("Customer#", key[i]);
+    address[i] = randomAddress(random);
+    nationKey[i] = random.uniform(0, NATIONS.size() - 1);
+    phones[i] = phone(random, nationKey[i]);
+    accountBalance[i] = money(random.uniform(-99999, 999999));
+    segment[i] = random.pick(SEGMENTS);
+    comment[i] = text(random, 29, 116);
+  });
+  return std::move(table).build();
+}
+
+static boss::ExpressionArguments generateOrders(ScaleFactor const& scaleFactor,
+                                                DateEncoding const& dateEncoding) {
+  TableBuilder table(static_cast<size_t>(scaleFactor.orders()));
+  auto key = table.numeric<int64_t>("o_orderkey");
+  auto custKey = table.numeric<int64_t>("o_custkey");
+  auto status = table.strings("o_orderstatus");
+  auto totalPrice = table.numeric<double_t>("o_totalprice");
+  auto date = table.date("o_orderdate", dateEncoding);
+  auto priority = table.strings("o_orderpriority");
+  auto clerk = table.strings("o_clerk");
+  auto shipPriority = table.numeric<int64_t>("o_shippriority");
+  auto comment = table.strings("o_comment");
+  auto clerks = std::max<int64_t>(1, std::llround(1000 * scaleFactor.scale));
+  table.forEachRow([&](size_t i) {
+    auto orderIndex = static_cast<int64_t>(i);
+    RowRandom random(ORDERS_SEED, i);
+    auto orderDate = random.uniform(START_DATE, END_DATE - 151);
+    key[i] = orderKey(orderIndex);
+    custKey[i] = orderingCustomer(random, scaleFactor.customers());
+    date.set(i, orderDate);
+    priority[i] = random.pick(PRIORITIES);
+    clerk[i] = numbered("Clerk#", random.uniform(1, clerks));
+    shipPriority[i] = 0;
+    comment[i] = text(random, 19, 78);
+
+    double_t total = 0;
+    int64_t shipped = 0;
+    auto lines = numLineItems(orderIndex);
+    for(int64_t line = 1; line <= lines; ++line) {
+      auto lineRandom = lineItemRandom(orderIndex, line);
+      auto item = lineItem(scaleFactor, orderDate, lineRandom);
+      total += item.extendedPrice * static_cast<double_t>(100 + item.tax) *
+               static_cast<double_t>(100 - item.discount) / 10000.0;
+      shipped += item.shipDate > CURRENT_DATE ? 0 : 1;
+    }
+    totalPrice[i] = std::round(total * 100.0) / 100.0;
+    status[i] = shipped == lines ? "F" : (shipped == 0 ? "O" : "P");
+  });
+  return std::move(table).build();
+}
+
+static boss::ExpressionArguments generateLineitem(ScaleFactor const& scaleFactor,
+                                                  DateEncoding const& dateEncoding) {
+  auto orders = static_cast<size_t>(scaleFactor.orders());
+  std::vector<int64_t> offsets(orders + 1, 0);
+  utilities::parallelForChunks(orders, ROWS_PER_CHUNK, [&offsets](size_t begin, size_t end) {
+    for(auto i = begin; i < end; ++i) {
+      offsets[i + 1] = numLineItems(static_cast<int64_t>(i));
+    }
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  TableBuilder table(static_cast<size_t>(offsets.back()));
+  auto key = table.numeric<int64_t>("l_orderkey");
+  auto partKey = table.numeric<int64_t>("l_partkey");
+  auto suppKey = table.numeric<int64_t>("l_suppkey");
+  auto lineNumber = table.numeric<int64_t>("l_linenumber");
+  auto quantity = table.numeric<int64_t>("l_quantity");
+  auto extendedPrice = table.numeric<double_t>("l_extendedprice");
+  auto discount = table.numeric<double_t>("l_discount");
+  auto tax = table.numeric<double_t>("l_tax");
+  auto returnFlag = table.strings("l_returnflag");
+  auto lineStatus = table.strings("l_linestatus");
+  auto shipDate = table.date("l_shipdate", dateEncoding);
+  auto commitDate = table.date("l_commitdate", dateEncoding);
+  auto receiptDate = table.date("l_receiptdate", dateEncoding);
+  auto instruction = table.strings("l_shipinstruct");
+  auto shipMode = table.strings("l_shipmode");
+  auto comment = table.strings("l_comment");
+  utilities::parallelForChunks(orders, ROWS_PER_CHUNK, [&](size_t begin, size_t end) {
+    for(auto orderIndex = static_cast<int64_t>(begin); orderIndex < static_cast<int64_t>(end);
+        ++orderIndex) {
+      auto orderDate = RowRandom(ORDERS_SEED, orderIndex).uniform(START_DATE, END_DATE - 151);
+      for(auto i = static_cast<size_t>(offsets[orderIndex]);
+          i < static_cast<size_t>(offsets[orderIndex + 1]); ++i) {
+        auto line = static_cast<int64_t>(i) - offsets[orderIndex] + 1;
+        auto random = lineItemRandom(orderIndex, line);
+        auto item = lineItem(scaleFactor, orderDate, random);
+        key[i] = orderKey(orderIndex);
+        partKey[i] = item.partKey;
+        suppKey[i] = item.suppKey;
+        lineNumber[i] = line;
+        quantity[i] = item.quantity;
+        extendedPrice[i] = item.extendedPrice;
+        discount[i] = static_cast<double_t>(item.discount) / 100.0;
+        tax[i] = static_cast<double_t>(item.tax) / 100.0;
+        returnFlag[i] = item.receiptDate <= CURRENT_DATE ? (random.uniform(0, 1) ? "R" : "A") : "N";
+        lineStatus[i] = item.shipDate > CURRENT_DATE ? "O" : "F";
+        shipDate.set(i, item.shipDate);
+        commitDate.set(i, item.commitDate);
+        receiptDate.set(i, item.receiptDate);
+        instruction[i] = random.pick(INSTRUCTIONS);
+        shipMode[i] = random.pick(SHIP_MODES);
+        comment[i] = text(random, 10, 43);
+      }
+    }
+  });
+  return std::move(table).build();
+}
+
+// Evaluates "DateObject"_ in the engine to find out how dates are stored in columns
+template <typename Evaluate> DateEncoding discoverDateEncoding(Evaluate&& evaluate) {
+  auto epoch = evaluate("DateObject"_("1970-01-01"));
+  auto nextDay = evaluate("DateObject"_("1970-01-02"));
+  DateEncoding encoding;
+  if(std::holds_alternative<int32_t>(epoch) && std::holds_alternative<int32_t>(nextDay)) {
+    encoding.asInt32 = true;
+    encoding.epoch = std::get<int32_t>(epoch);
+    encoding.perDay = std::get<int32_t>(nextDay) - encoding.epoch;
+  } else if(std::holds_alternative<int64_t>(epoch) && std::holds_alternative<int64_t>(nextDay)) {
+    encoding.epoch = std::get<int64_t>(epoch);
+    encoding.perDay = std::get<int64_t>(nextDay) - encoding.epoch;
+  } else {
+    std::cerr << "Warning: unknown date representation " << epoch
+              << ", generating dates as int32 days since 1970-01-01" << std::endl;
+    encoding.asInt32 = true;
+  }
+  return encoding;
+}
+
+// Generates the columns of a TPC-H table (by its dbgen file name, e.g. "lineitem") at a scale
+// factor, as the "Data"_ for LoadDataTable
+static boss::ExpressionArguments generateTable(std::string const& filename, double scaleFactor,
+                                               DateEncoding const& dateEncoding) {
+  ScaleFactor scale(scaleFactor);
+  if(filename == "region") {
+    return generateRegion();
+  }
+  if(filename == "nation") {
+    return generateNation();
+  }
+  if(filename == "part") {
+    return generatePart(scale);
+  }
+  if(filename == "supplier") {
+    return generateSupplier(scale);
+  }
+  if(filename == "partsupp") {
+    return generatePartsupp(scale);
+  }
+  if(filename == "customer") {
+    return generateCustomer(scale);
+  }
+  if(filename == "orders") {
+    return generateOrders(scale, dateEncoding);
+  }
+  if(filename == "lineitem") {
+    return generateLineitem(scale, dateEncoding);
+  }
+  throw std::runtime_error("unknown TPC-H table: " + filename);
+}
+
+// Column types of the .tbl files, as generateTable emits them
+enum class ColumnType { INT64, DOUBLE, STRING, DATE };
+
+static std::vector<std::pair<std::string, ColumnType>> const& tableSchema(
+    std::string const& filename) {
+  using enum ColumnType;
+  static std::map<std::string, std::vector<std::pair<std::string, ColumnType>>> const schemas = {
+      {"region", {{"r_regionkey", INT64}, {"r_name", STRING}, {"r_comment", STRING}}},
+      {"nation",
+       {{"n_nationkey", INT64}, {"n_name", STRING}, {"n_regionkey", INT64}, {"n_comment", STRING}}},
+      {"part",
+       {{"p_partkey", INT64},
+        {"p_name", STRING},
+        {"p_mfgr", STRING},
+        {"p_brand", STRING},
+        {"p_type", STRING},
+        {"p_size", INT64},
+        {"p_container", STRING},
+        {"p_retailprice", DOUBLE},
+        {"p_comment", STRING}}},
+      {"supplier",
+       {{"s_suppkey", INT64},
+        {"s_name", STRING},
+        {"s_address", STRING},
+        {"s_nationkey", INT64},
+        {"s_phone", STRING},
+        {"s_acctbal", DOUBLE},
+        {"s_comment", STRING}}},
+      {"partsupp",
+       {{"ps_partkey", INT64},
+        {"ps_suppkey", INT64},
+        {"ps_availqty", INT64},
+        {"ps_supplycost", DOUBLE},
+        {"ps_comment", STRING}}},
+      {"customer",
+       {{"c_custkey", INT64},
+        {"c_name", STRING},
+        {"c_address", STRING},
+        {"c_nationkey", INT64},
+        {"c_phone", STRING},
+        {"c_acctbal", DOUBLE},
+        {"c_mktsegment", STRING},
+        {"c_comment", STRING}}},
+      {"orders",
+       {{"o_orderkey", INT64},
+        {"o_custkey", INT64},
+        {"o_orderstatus", STRING},
+        {"o_totalprice", DOUBLE},
+        {"o_orderdate", DATE},
+        {"o_orderpriority", STRING},
+        {"o_clerk", STRING},
+        {"o_shippriority", INT64},
+        {"o_comment", STRING}}},
+      {"lineitem",
+       {{"l_orderkey", INT64},
+        {"l_partkey", INT64},
+        {"l_suppkey", INT64},
+        {"l_linenumber", INT64},
+        {"l_quantity", INT64},
+        {"l_extendedprice", DOUBLE},
+        {"l_discount", DOUBLE},
+        {"l_tax", DOUBLE},
+        {"l_returnflag", STRING},
+        {"l_linestatus", STRING},
+        {"l_shipdate", DATE},
+        {"l_commitdate", DATE},
+        {"l_receiptdate", DATE},
+        {"l_shipinstruct", STRING},
+        {"l_shipmode", STRING},
+        {"l_comment", STRING}}}};
+  auto it = schemas.find(filename);
+  if(it == schemas.end()) {
+    throw std::runtime_error("unknown TPC-H table: " + filename);
+  }
+  return it->second;
+}
+
+constexpr size_t PARSING_CHUNK_SIZE = size_t(1) << 24U;
+
+// Parses a dbgen .tbl file ('|'-terminated fields, one row per line) into the same typed columns
+// as generateTable. The memory-mapped file is split into byte chunks, each owning the lines that
+// start in it: a first parallel pass counts the lines per chunk and a second one parses them into
+// their rows. Returns nothing if the file cannot be read.
+static std::optional<boss::ExpressionArguments> parseTable(std::string const& filename,
+                                                           std::string const& path,
+                                                           DateEncoding const& dateEncoding) {
+  auto const& schema = tableSchema(filename);
+  auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if(fd < 0) {
+    return {};
+  }
+  struct stat fileStatus {};
+  fstat(fd, &fileStatus);
+  auto fileSize = static_cast<size_t>(fileStatus.st_size);
+  void* mapped = fileSize == 0 ? nullptr : mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(mapped == MAP_FAILED) {
+    return {};
+  }
+  madvise(mapped, fileSize, MADV_SEQUENTIAL);
+  auto const* data = static_cast<char const*>(mapped);
+
+  auto numChunks = (fileSize + PARSING_CHUNK_SIZE - 1) / PARSING_CHUNK_SIZE;
+  std::vector<size_t> chunkOffsets(numChunks + 1, 0);
+  utilities::parallelForChunks(fileSize, PARSING_CHUNK_SIZE, [&](size_t begin, size_t end) {
+    // a line starts at 0 and after every '\n' but the last byte's
+    chunkOffsets[begin / PARSING_CHUNK_SIZE + 1] =
+        (begin == 0 ? 1 : 0) +
+        utilities::countNewlines(data + (begin == 0 ? 0 : begin - 1), data + end - 1);
+  });
+  std::partial_sum(chunkOffsets.begin(), chunkOffsets.end(), chunkOffsets.begin());
+
+  TableBuilder table(chunkOffsets.back());
+  std::vector<std::variant<Column<int64_t>, Column<double_t>, Column<std::string>, DateColumn>>
+      columns;
+  for(auto const& [name, type] : schema) {
+    switch(type) {
+    case ColumnType::INT64:
+      columns.emplace_back(table.numeric<int64_t>(name));
+      break;
+    case ColumnType::DOUBLE:
+      columns.emplace_back(table.numeric<double_t>(name));
+      break;
+    case ColumnType::STRING:
+      columns.emplace_back(table.strings(name));
+      break;
+    case ColumnType::DATE:
+      columns.emplace_back(table.date(name, dateEncoding));
+      break;
+    }
+  }
+
+  utilities::parallelForChunks(fileSize, PARSING_CHUNK_SIZE, [&](size_t begin, size_t end) {
+    auto row = chunkOffsets[begin / PARSING_CHUNK_SIZE];
+    auto const* line = data + begin;
+    if(begin > 0 && data[begin - 1] != '\n') {
+      line = static_cast<char const*>(std::memchr(line, '\n', end - begin));
+      line = line == nullptr ? data + end : line + 1;
+    }
+    auto const* fileEnd = data + fileSize;
+    for(; line < data + end; ++row) {
+      auto const* field = line;
+      for(auto& column : columns) {
+        auto const* fieldEnd = std::find_if(field, fileEnd, [](char c) {
+          return c == '|' || c == '\n';
+        });
+        std::visit(
+            [&]<typename C>(C const& typedColumn) {
+              if constexpr(std::is_same_v<C, Column<std::string>>) {
+                typedColumn[row].assign(field, fieldEnd);
+              } else if constexpr(std::is_same_v<C, DateColumn>) {
+                int year = 0;
+                int month = 0;
+                int day = 0;
+                auto parsed = std::from_chars(field, fieldEnd, year);
+                parsed = std::from_chars(parsed.ptr + 1, fieldEnd, month);
+                std::from_chars(parsed.ptr + 1, fieldEnd, day);
+                typedColumn.set(row, daysFromCivil(year, month, day));
+              } else {
+                std::from_chars(field, fieldEnd, typedColumn[row]);
+              }
+            },
+            column);
+        field = fieldEnd < fileEnd && *fieldEnd == '|' ? fieldEnd + 1 : fieldEnd;
+      }
+      auto const* lineEnd = static_cast<char const*>(std::memchr(field, '\n', fileEnd - field));
+      line = lineEnd == nullptr ? fileEnd : lineEnd + 1;
+    }
+  });
+
+  if(mapped != nullptr) {
+    munmap(mapped, fileSize);
+  }
+  return std::move(table).build();
+}
+
+} // namespace tpchGeneration
+
+#endif // TPCHGENERATION_CPP
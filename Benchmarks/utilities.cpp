@@ -3,14 +3,53 @@
 
 #include <BOSS.hpp>
 #include <ExpressionUtilities.hpp>
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 #include "config.hpp"
 
 using namespace boss::utilities;
 
 namespace utilities {
+static boss::expressions::ExpressionSpanArgument
+shallowCopy(boss::expressions::ExpressionSpanArgument const& span) {
+  return std::visit(
+      [](auto const& typedSpan) -> boss::expressions::ExpressionSpanArgument {
+        // just do a shallow copy of the span
+        // the storage's span keeps the ownership
+        // (since the storage will be alive until the query finishes)
+        using SpanType = std::decay_t<decltype(typedSpan)>;
+        using T = std::remove_const_t<typename SpanType::element_type>;
+        if constexpr(std::is_same_v<T, bool>) {
+          // this would still keep const spans for bools, need to fix later
+          return SpanType(typedSpan.begin(), typedSpan.size(), []() {});
+        } else {
+          // force non-const value for now (otherwise expressions cannot be moved)
+          auto* ptr = const_cast<T*>(typedSpan.begin()); // NOLINT
+          return boss::Span<T>(ptr, typedSpan.size(), []() {});
+        }
+      },
+      span);
+}
+
 static boss::ComplexExpression shallowCopy(boss::ComplexExpression const& e) {
   auto const& head = e.getHead();
   auto const& dynamics = e.getDynamicArguments();
@@ -27,25 +66,8 @@ static boss::ComplexExpression shallowCopy(boss::ComplexExpression const& e) {
                        arg);
                  });
   boss::expressions::ExpressionSpanArguments spansCopy;
-  std::transform(spans.begin(), spans.end(), std::back_inserter(spansCopy), [](auto const& span) {
-    return std::visit(
-        [](auto const& typedSpan) -> boss::expressions::ExpressionSpanArgument {
-          // just do a shallow copy of the span
-          // the storage's span keeps the ownership
-          // (since the storage will be alive until the query finishes)
-          using SpanType = std::decay_t<decltype(typedSpan)>;
-          using T = std::remove_const_t<typename SpanType::element_type>;
-          if constexpr(std::is_same_v<T, bool>) {
-            // this would still keep const spans for bools, need to fix later
-            return SpanType(typedSpan.begin(), typedSpan.size(), []() {});
-          } else {
-            // force non-const value for now (otherwise expressions cannot be moved)
-            auto* ptr = const_cast<T*>(typedSpan.begin()); // NOLINT
-            return boss::Span<T>(ptr, typedSpan.size(), []() {});
-          }
-        },
-        span);
-  });
+  std::transform(spans.begin(), spans.end(), std::back_inserter(spansCopy),
+                 [](auto const& span) { return shallowCopy(span); });
   return {head, {}, std::move(dynamicsCopy), std::move(spansCopy)};
 }
 
@@ -77,15 +99,136 @@ static boss::Expression injectDebugInfoToSpans(boss::Expression&& expr) {
           [](auto&& otherTypes) -> boss::Expression { return otherTypes; }),
       std::move(expr));
 }
+
+constexpr size_t SPAN_BUFFER_ALIGNMENT = 64;
+
+// Allocates a single uninitialised, cache-line aligned buffer of n elements. Ownership of the
+// buffer moves with the returned span and it is freed by the span's destructor, so generators can
+// write straight into the memory that the engines end up owning.
+template <typename T> boss::Span<T> allocateAlignedSpan(size_t n) {
+  static_assert(std::is_trivially_destructible_v<T>, "Buffer elements are never destructed");
+  auto bytes = std::max(n * sizeof(T), SPAN_BUFFER_ALIGNMENT);
+  bytes = (bytes + SPAN_BUFFER_ALIGNMENT - 1) / SPAN_BUFFER_ALIGNMENT * SPAN_BUFFER_ALIGNMENT;
+  auto* buffer = static_cast<T*>(std::aligned_alloc(SPAN_BUFFER_ALIGNMENT, bytes));
+  if(buffer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return boss::Span<T>(buffer, n, [buffer]() { std::free(buffer); }); // NOLINT
+}
+
+// Tables are handed to the engines in partitions (multiple spans per column) of this many rows.
+// A power of two, so that partitions of any element type start at page-aligned offsets.
+constexpr size_t LOAD_PARTITION_ROWS = size_t(1) << 22U;
+
+static size_t numDataGenerationThreads() {
+  if(NUM_DATA_GENERATION_THREADS > 0) {
+    return static_cast<size_t>(NUM_DATA_GENERATION_THREADS);
+  }
+  return numa::availableCPUs(); // e.g. the CPUs of the node of --numa-policy
+}
+
+// Calls func(begin, end) for every chunk of [0, n), distributing the chunks over the data
+// generation threads. Chunk boundaries depend only on n and chunkSize (not on the number of
+// threads), so any per-chunk state derived from the chunk index is deterministic.
+template <typename Func> void parallelForChunks(size_t n, size_t chunkSize, Func&& func) {
+  auto numChunks = (n + chunkSize - 1) / chunkSize;
+  auto numThreads = std::min(numDataGenerationThreads(), numChunks);
+  std::atomic<size_t> nextChunk = 0;
+  auto worker = [&]() {
+    auto traceScope = traceEvents.scope("generation worker", "generation");
+    for(auto chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+      auto begin = chunk * chunkSize;
+      func(begin, std::min(n, begin + chunkSize));
+    }
+  };
+  if(numThreads <= 1) {
+    worker();
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for(size_t i = 1; i < numThreads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for(auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Reports the hardware counters of the last timed loop (between perfCounters.start() and stop())
+// per iteration and, if numTuples > 0, per tuple of the benchmark's data set, plus the IPC (only
+// counted by the first client thread, see --clients)
+static void reportPerfCounters(benchmark::State& state, int64_t numTuples) {
+  if(!perfCounters.isOpen() || state.thread_index() != 0 || state.iterations() == 0) {
+    return;
+  }
+  double cycles = 0;
+  double instructions = 0;
+  for(auto const& [name, value] : perfCounters.read()) {
+    state.counters[name] = benchmark::Counter(value, benchmark::Counter::kAvgIterations);
+    if(numTuples > 0) {
+      state.counters[name + "/tuple"] = benchmark::Counter(
+          value / static_cast<double>(numTuples), benchmark::Counter::kAvgIterations);
+    }
+    cycles = name == "cycles" ? value : cycles;
+    instructions = name == "instructions" ? value : instructions;
+  }
+  if(cycles > 0 && instructions > 0) {
+    state.counters["IPC"] = instructions / cycles;
+  }
+}
+
+// Bytes of a column partition (the characters, for string columns)
+static int64_t spanBytes(boss::expressions::ExpressionSpanArgument const& span) {
+  return std::visit(
+      []<typename T>(boss::Span<T> const& typedSpan) -> int64_t {
+        if constexpr(std::is_same_v<std::remove_const_t<T>, std::string>) {
+          int64_t bytes = 0;
+          for(auto const& value : typedSpan) {
+            bytes += static_cast<int64_t>(value.size());
+          }
+          return bytes;
+        } else {
+          return static_cast<int64_t>(typedSpan.size() * sizeof(T));
+        }
+      },
+      span);
+}
+
+// Reports the tuples of the tables and the bytes of the columns that a benchmark's query refers to
+// per iteration, as items/s and column_bytes_per_second. The columns are counted in full, so this
+// is an upper bound of the bytes the engine scans (it may skip parts of them, e.g. after a
+// selective filter or with a late-materialising join). With --bandwidth-baseline, the column
+// bytes/s are also reported as a percentage of the memory read bandwidth measured at startup.
+static void reportThroughput(benchmark::State& state, int64_t numTuples, int64_t numColumnBytes) {
+  if(DISPATCH_FLOOR) {
+    return; // nothing is scanned
+  }
+  state.SetItemsProcessed(state.iterations() * numTuples);
+  auto columnBytes = static_cast<double>(state.iterations() * numColumnBytes);
+  state.counters["column_bytes_per_second"] =
+      benchmark::Counter(columnBytes, benchmark::Counter::kIsRate, benchmark::Counter::kIs1024);
+  if(MEMORY_READ_BANDWIDTH > 0) {
+    state.counters["column_read_bandwidth_%"] = benchmark::Counter(
+        columnBytes * 100 / MEMORY_READ_BANDWIDTH, benchmark::Counter::kIsRate); // NOLINT
+  }
+}
 } // namespace utilities
 
+// Buffers owned by the harness for the latest data set: the engines only get shallow copies of
+// these spans, so they are released after the data set's tables are dropped
+static std::vector<boss::expressions::ExpressionSpanArgument> latestDataSetSpans;
+
 void resetStorageEngine() {
+  auto traceScope = traceEvents.scope("resetStorageEngine", "storage");
+  traceScope.argument("dataSet", latestDataSet);
   auto evalStorage = [](boss::Expression&& expression) mutable {
     return boss::evaluate(
         "EvaluateInEngines"_("List"_(librariesToTest[0]), std::move(expression)));
   };
 
-  if(latestDataSet == "TPCH") {
+  if(latestDataSet == "TPCH" || latestDataSet == "TPCH_GENERATED") {
     evalStorage("DropTable"_("REGION"_));
     evalStorage("DropTable"_("NATION"_));
     evalStorage("DropTable"_("PART"_));
@@ -102,22 +245,136 @@ void resetStorageEngine() {
     evalStorage("DropTable"_("LINEITEM"_));
     evalStorage("DropTable"_("LINEITEM_CLUSTERED"_));
   }
+  latestDataSetSpans.clear();
 }
 
-size_t getNumberOfRowsInTable(std::string& filepath) {
-  std::ifstream file(filepath);
-  if (!file.is_open()) {
-    std::cerr << "Error: Unable to open file " << filepath << std::endl;
+namespace utilities {
+constexpr size_t ROW_COUNTING_CHUNK_SIZE = size_t(1) << 24U;
+
+static size_t countNewlinesScalar(char const* begin, char const* end) {
+  return static_cast<size_t>(std::count(begin, end, '\n'));
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2"))) static size_t countNewlinesAVX2(char const* begin,
+                                                                  char const* end) {
+  size_t count = 0;
+  auto newlines = _mm256_set1_epi8('\n');
+  for(; begin + sizeof(__m256i) <= end; begin += sizeof(__m256i)) {
+    auto block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(begin));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newlines)));
+    count += static_cast<size_t>(__builtin_popcount(mask));
+  }
+  return count + countNewlinesScalar(begin, end);
+}
+
+static size_t countNewlinesSSE2(char const* begin, char const* end) {
+  size_t count = 0;
+  auto newlines = _mm_set1_epi8('\n');
+  for(; begin + sizeof(__m128i) <= end; begin += sizeof(__m128i)) {
+    auto block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(begin));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newlines)));
+    count += static_cast<size_t>(__builtin_popcount(mask));
+  }
+  return count + countNewlinesScalar(begin, end);
+}
+#endif
+
+static size_t countNewlines(char const* begin, char const* end) {
+#if defined(__x86_64__)
+  static bool const hasAVX2 = __builtin_cpu_supports("avx2");
+  return hasAVX2 ? countNewlinesAVX2(begin, end) : countNewlinesSSE2(begin, end);
+#else
+  return countNewlinesScalar(begin, end);
+#endif
+}
+
+// Counts the lines of a memory-mapped file in parallel (a last line without '\n' counts too),
+// if the file can be mapped
+static std::optional<size_t> countRowsInFile(std::string const& filepath, size_t fileSize) {
+  if(fileSize == 0) {
     return 0;
   }
+  auto fd = open(filepath.c_str(), O_RDONLY);
+  if(fd < 0) {
+    return {};
+  }
+  auto* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(mapped == MAP_FAILED) {
+    return {};
+  }
+  madvise(mapped, fileSize, MADV_SEQUENTIAL);
+  auto const* data = static_cast<char const*>(mapped);
 
-  size_t rowCount = 0;
-  std::string line;
-  while (std::getline(file, line)) {
+  std::vector<size_t> chunkCounts((fileSize + ROW_COUNTING_CHUNK_SIZE - 1) /
+                                  ROW_COUNTING_CHUNK_SIZE);
+  parallelForChunks(fileSize, ROW_COUNTING_CHUNK_SIZE, [&](size_t begin, size_t end) {
+    chunkCounts[begin / ROW_COUNTING_CHUNK_SIZE] = countNewlines(data + begin, data + end);
+  });
+  auto rowCount = std::accumulate(chunkCounts.begin(), chunkCounts.end(), size_t(0));
+  if(data[fileSize - 1] != '\n') {
     ++rowCount;
   }
 
-  file.close();
+  munmap(mapped, fileSize);
+  return rowCount;
+}
+} // namespace utilities
+
+// Row counts are cached in a sidecar next to the data directory (e.g. ../data/tpch_1000MB.rows),
+// one "<filename> <rows> <file size> <mtime in ns>" line per counted file, and are only reused
+// while the file's size and mtime match. Returns nothing if the file cannot be read.
+std::optional<size_t> getNumberOfRowsInTable(std::string const& filepath) {
+  struct stat fileStatus {};
+  if(stat(filepath.c_str(), &fileStatus) != 0) {
+    std::cerr << "Error: Unable to open file " << filepath << std::endl;
+    return {};
+  }
+  auto fileSize = static_cast<size_t>(fileStatus.st_size);
+  auto modificationTime = static_cast<int64_t>(fileStatus.st_mtim.tv_sec) * 1000000000 +
+                          static_cast<int64_t>(fileStatus.st_mtim.tv_nsec);
+
+  auto separator = filepath.find_last_of('/');
+  auto directory =
+      separator == std::string::npos ? std::string(".") : filepath.substr(0, separator);
+  auto filename = separator == std::string::npos ? filepath : filepath.substr(separator + 1);
+  auto sidecarPath = directory + ".rows";
+
+  std::map<std::string, std::tuple<size_t, size_t, int64_t>> sidecar;
+  {
+    std::ifstream sidecarFile(sidecarPath);
+    std::string name;
+    size_t rows = 0;
+    size_t size = 0;
+    int64_t mtime = 0;
+    while(sidecarFile >> name >> rows >> size >> mtime) {
+      sidecar[name] = {rows, size, mtime};
+    }
+  }
+  if(auto it = sidecar.find(filename); it != sidecar.end()) {
+    auto [rows, size, mtime] = it->second;
+    // (a non-empty file has at least one row: 0 was recorded by a failed count)
+    if(size == fileSize && mtime == modificationTime && (rows > 0 || fileSize == 0)) {
+      return rows;
+    }
+  }
+
+  auto traceScope = traceEvents.scope("count rows", "storage");
+  traceScope.argument("file", filepath);
+  auto rowCount = utilities::countRowsInFile(filepath, fileSize);
+  traceScope.end();
+  if(!rowCount) {
+    std::cerr << "Error: Unable to read file " << filepath << std::endl;
+    return {};
+  }
+
+  sidecar[filename] = {*rowCount, fileSize, modificationTime};
+  std::ofstream sidecarFile(sidecarPath, std::ios::trunc);
+  for(auto const& [name, entry] : sidecar) {
+    auto [rows, size, mtime] = entry;
+    sidecarFile << name << " " << rows << " " << size << " " << mtime << std::endl;
+  }
   return rowCount;
 }
 
@@ -0,0 +1,25 @@
+#include <BOSS.hpp>
+#include <ExpressionUtilities.hpp>
+
+#include <utility>
+
+// Engine that evaluates every expression to an empty table without looking at it, i.e. it only
+// takes ownership of (and destroys) its argument. Benchmarks run against it (--dispatch-floor)
+// measure the fixed cost of the harness and of boss::evaluate's dispatch for a query's shape.
+namespace boss::engines::noop {
+class Engine {
+public:
+  static Expression evaluate(Expression&& expression) {
+    auto consumed = std::move(expression);
+    return ComplexExpression(Symbol("Table"), {}, {}, {});
+  }
+};
+} // namespace boss::engines::noop
+
+// no lock around evaluate: the engine is stateless, so concurrent clients (--clients) only measure
+// the dispatch itself
+extern "C" BOSSExpression* evaluate(BOSSExpression* e) {
+  return new BOSSExpression{boss::engines::noop::Engine::evaluate(std::move(e->delegate))};
+}
+
+extern "C" void reset() {}